@@ -0,0 +1,89 @@
+/**
+ * @file animatednoise.cpp
+ * @brief cnv::AnimatedNoise implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <cmath>
+
+#include <canvas/animatednoise.h>
+#include <canvas/parallel.h>
+
+namespace cnv {
+
+AnimatedNoise::AnimatedNoise(const PerlinNoise& noise, size_t cols, size_t rows, const std::vector<PerlinNoise::Octave>& octaves, float spacing) :
+	_noise(noise),
+	_cols(cols),
+	_rows(rows),
+	_octaves(octaves),
+	_spacing(spacing),
+	_index(0),
+	_valid(false)
+{
+	_slices[0] = std::vector<float>(cols * rows, 0.0f);
+	_slices[1] = std::vector<float>(cols * rows, 0.0f);
+	_next = std::vector<float>(cols * rows, 0.0f);
+	_values = std::vector<float>(cols * rows, 0.0f);
+}
+
+AnimatedNoise::~AnimatedNoise()
+{
+	wait();
+}
+
+void AnimatedNoise::compute(std::vector<float>& slice, int64_t index, bool threaded) const
+{
+	float z = (double)index * _spacing;
+	_noise.fillGrid(slice.data(), _cols, _rows, 0.0f, 1.0f / _cols, 0.0f, 1.0f / _rows, z, _octaves, threaded);
+}
+
+void AnimatedNoise::prefetch()
+{
+	// one thread, leave the ThreadPool to the frame
+	int64_t index = _index + 2;
+	_pending = std::async(std::launch::async, [this, index]() {
+		compute(_next, index, false);
+	});
+}
+
+void AnimatedNoise::wait()
+{
+	if (_pending.valid()) {
+		_pending.wait();
+	}
+}
+
+const std::vector<float>& AnimatedNoise::sample(float z)
+{
+	double position = z / _spacing;
+	int64_t index = std::floor(position);
+	float t = position - index;
+
+	if (_valid && index == _index + 1) {
+		// on to the next slice, that was computed in the background
+		wait();
+		std::swap(_slices[0], _slices[1]);
+		std::swap(_slices[1], _next);
+		_index = index;
+		prefetch();
+	} else if (!_valid || index != _index) {
+		wait();
+		compute(_slices[0], index, true);
+		compute(_slices[1], index + 1, true);
+		_index = index;
+		_valid = true;
+		prefetch();
+	}
+
+	const std::vector<float>& a = _slices[0];
+	const std::vector<float>& b = _slices[1];
+	parallel_for_rows(_rows, [&](const RowBand& band) {
+		for (size_t i = band.begin * _cols; i < band.end * _cols; i++) {
+			_values[i] = a[i] + t * (b[i] - a[i]);
+		}
+	}, _cols * sizeof(float) * 3);
+
+	return _values;
+}
+
+} // namespace cnv
@@ -0,0 +1,65 @@
+/**
+ * @file animatednoise.h
+ * @brief cnv::AnimatedNoise header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef ANIMATEDNOISE_H
+#define ANIMATEDNOISE_H
+
+#include <cstdint>
+#include <future>
+#include <vector>
+
+#include <canvas/noise.h>
+
+namespace cnv {
+
+/// @brief A grid of noise that changes slowly over z (time).
+/// Only every spacing in z a slice of noise is computed; everything in between is a lerp of the
+/// 2 slices around it. While those are used, the next slice is computed on a thread of its own, so
+/// going forward in z costs one pass over the grid per frame.
+/// The highest frequency times spacing should stay below about 0.5, or the lerp shows.
+class AnimatedNoise
+{
+public:
+	/// @brief the grid covers 0.0 - 1.0 in x and y, like PerlinNoise::fillGrid(out, cols, rows, 0, 1/cols, 0, 1/rows, ...)
+	/// @param noise the noise (copied)
+	/// @param cols number of columns
+	/// @param rows number of rows
+	/// @param octaves the octaves
+	/// @param spacing distance in z between 2 slices
+	AnimatedNoise(const PerlinNoise& noise, size_t cols, size_t rows, const std::vector<PerlinNoise::Octave>& octaves, float spacing = 0.02f);
+	virtual ~AnimatedNoise();
+
+	size_t cols() const { return _cols; }
+	size_t rows() const { return _rows; }
+	float spacing() const { return _spacing; }
+
+	/// @brief the grid at z. Going back, or further than a slice at once, computes the slices right away.
+	/// @param z z
+	/// @return cols*rows values (0.0 - 1.0), row by row, until the next call
+	const std::vector<float>& sample(float z);
+
+private:
+	PerlinNoise _noise;
+	size_t _cols;
+	size_t _rows;
+	std::vector<PerlinNoise::Octave> _octaves;
+	float _spacing;
+
+	std::vector<float> _slices[2]; // at z = _index*spacing and (_index+1)*spacing
+	int64_t _index;
+	bool _valid;
+	std::vector<float> _next; // (_index+2)*spacing, being computed while _pending
+	std::future<void> _pending;
+	std::vector<float> _values;
+
+	void compute(std::vector<float>& slice, int64_t index, bool threaded) const;
+	void prefetch();
+	void wait();
+};
+
+} // namespace cnv
+
+#endif /* ANIMATEDNOISE_H */
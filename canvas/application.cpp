@@ -4,19 +4,40 @@
  * @see https://github.com/rktrlng/pixelbuffer
  */
 
+#include <cstdlib>
+#include <cstring>
+
 #include <canvas/application.h>
 
 namespace cnv {
 
-Application::Application(uint16_t width, uint16_t height, uint8_t bitdepth, uint8_t factor) :
-	renderer(width*factor, height*factor),
+static bool headlessFromEnv()
+{
+	const char* value = std::getenv("CANVAS_HEADLESS");
+	return value != nullptr && value[0] != '\0' && strcmp(value, "0") != 0;
+}
+
+Application::Application(uint16_t width, uint16_t height, uint8_t bitdepth, uint8_t factor, bool headless) :
+	renderer(width*factor, height*factor, headless || headlessFromEnv()),
+	_stop(false),
+	_stepcounter(0),
+	_stopworker(false),
+	_polled(renderer.window()),
+	_events(renderer.window()),
+	_pending(renderer.window()),
 	input(renderer.window())
 {
 	layers.push_back( new cnv::Canvas(width, height, bitdepth, factor) );
 }
 
-Application::Application(rt::PixelBuffer& pixelbuffer, uint8_t factor, bool setlocked /* false */) :
-	renderer(pixelbuffer.width() * factor, pixelbuffer.height() * factor),
+Application::Application(rt::PixelBuffer& pixelbuffer, uint8_t factor, bool setlocked /* false */, bool headless /* false */) :
+	renderer(pixelbuffer.width() * factor, pixelbuffer.height() * factor, headless || headlessFromEnv()),
+	_stop(false),
+	_stepcounter(0),
+	_stopworker(false),
+	_polled(renderer.window()),
+	_events(renderer.window()),
+	_pending(renderer.window()),
 	input(renderer.window())
 {
 	uint16_t cols = pixelbuffer.width();
@@ -31,6 +52,9 @@ Application::Application(rt::PixelBuffer& pixelbuffer, uint8_t factor, bool setl
 
 Application::~Application()
 {
+	// normally already stopped by quit(). The derived class is gone by now, so this is only a safety net.
+	stopWorker();
+
 	for (auto canvas : layers) {
 		delete canvas;
 	}
@@ -41,9 +65,21 @@ Application::~Application()
 
 int Application::quit()
 {
+	if (_stop) {
+		stopWorker();
+		if (!renderer.headless()) {
+			glfwTerminate();
+		}
+		return 1;
+	}
+	if (renderer.headless()) {
+		return 0;
+	}
+
 	if (glfwGetKey(renderer.window(), GLFW_KEY_ESCAPE ) == GLFW_PRESS ||
 		glfwWindowShouldClose(renderer.window()) )
 	{
+		stopWorker();
 		glfwTerminate();
 		return 1;
 	}
@@ -56,6 +92,17 @@ int Application::run()
 	// Update deltaTime
 	float deltaTime = renderer.updateDeltaTime();
 
+	// no window: just the user application at full speed
+	if (renderer.headless()) {
+		// nothing uploads the layers, so this is where they get up to date
+		if (this->simulate(deltaTime)) {
+			for (auto& canvas : layers) {
+				canvas->resolve();
+			}
+		}
+		return 1;
+	}
+
 	size_t cols = 0;
 	size_t rows = 0;
 	if (layers.size() > 0) {
@@ -79,20 +126,154 @@ int Application::run()
 		} else {
 			str = std::string(std::to_string(frames) + " FPS");
 		}
+		if (_steprate >= 0.0f) {
+			str += "    |    " + std::to_string(_stepcounter) + " steps/s";
+		}
 		glfwSetWindowTitle(renderer.window(), str.c_str());
 		frametime = 0.0f;
 		frames = 0;
+		_stepcounter = 0;
 	}
-	frames++;
 	// #########################################
 
-	input.updateInput(cols, rows);
+	if (_threaded) {
+		if (!_worker.joinable()) {
+			startWorker();
+		}
+
+		// hand the input to the simulation thread
+		_polled.updateInput(cols, rows);
+		{
+			std::lock_guard<std::mutex> lock(_inputmutex);
+			_events.accumulate(_polled);
+		}
+
+		// draw whatever the simulation thread finished last
+		bool fresh = false;
+		for (size_t i = 0; i < _handoff.size(); i++) {
+			if (_handoff[i]->acquire()) {
+				TripleBuffer::Frame& frame = _handoff[i]->front();
+				layers[i]->updateTexture(frame.pixels, frame.width, frame.height);
+				fresh = true;
+			}
+		}
+		if (fresh) {
+			this->render();
+			frames++;
+		} else {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		return 1;
+	}
+
+	// keys and clicks wait for a step to see them, however many frames that takes
+	_polled.updateInput(cols, rows);
+	_events.accumulate(_polled);
+	input = _events;
+
 	// update user application
-	this->update(deltaTime);
+	int steps = 0;
+	bool draw = this->simulate(deltaTime, &steps);
+	if (steps > 0) {
+		_events.clearEvents();
+	}
+	if (draw) {
+		this->render();
+		frames++;
+	}
+
+	return 1;
+}
+
+bool Application::simulate(float deltatime, int* steps)
+{
+	using clock = std::chrono::steady_clock;
+
+	// a new step rate counts from now
+	if (_restart.exchange(false)) {
+		_accumulator = 0.0f;
+		_laststep = clock::now();
+	}
+
+	// not scheduled: once per run()
+	float steprate = _steprate;
+	if (steprate < 0.0f) {
+		this->update(deltatime);
+		if (steps) { *steps = 1; }
+		return true;
+	}
+
+	// don't stay away from input (and the window) for too long
+	const float maxruntime = 1.0f / 30.0f;
+	// on a slow machine, forget about steps we can't catch up on
+	const float maxlag = 0.25f;
+
+	clock::time_point start = clock::now();
+	float stepsize = 0.0f;
+	if (steprate > 0.0f) {
+		stepsize = 1.0f / steprate;
+		_accumulator += deltatime;
+		if (_accumulator > maxlag) { _accumulator = maxlag; }
+	}
+
+	int counter = 0;
+	while (true) {
+		clock::time_point now = clock::now();
+		float runtime = std::chrono::duration<float>(now - start).count();
+		if (counter > 0 && runtime > maxruntime) { break; }
+		if (_renderevery > 0 && _stepssincerender >= _renderevery) { break; }
+		// update() changed the step rate, that's for next time
+		if (_restart) { break; }
+
+		if (steprate > 0.0f) {
+			if (_accumulator < stepsize) { break; }
+			_accumulator -= stepsize;
+			this->update(stepsize);
+		} else {
+			// turbo: until it's time to draw
+			if (_renderrate > 0.0f && std::chrono::duration<float>(now - _lastrender).count() >= 1.0f / _renderrate) { break; }
+			this->update(std::chrono::duration<float>(now - _laststep).count());
+			_laststep = now;
+		}
+
+		// keys and buttons go down or up only once, not every step
+		if (counter == 0) {
+			input.clearEvents();
+		}
+		counter++;
+		_stepssincerender++;
+		_stepcounter++;
+	}
+
+	bool draw = _renderevery == 0 && _renderrate <= 0.0f;
+	if (_renderevery > 0 && _stepssincerender >= _renderevery) { draw = true; }
+	if (_renderrate > 0.0f && std::chrono::duration<float>(clock::now() - _lastrender).count() >= 1.0f / _renderrate) { draw = true; }
+	if (draw) {
+		_lastrender = clock::now();
+		_stepssincerender = 0;
+	}
+	if (steps) { *steps = counter; }
 
+	return draw;
+}
+
+void Application::render()
+{
 	// Clear the screen
 	glClear(GL_COLOR_BUFFER_BIT);
 
+	// the simulation thread owns the layers, draw the copies we uploaded
+	if (_threaded) {
+		for (size_t i = 0; i < _handoff.size(); i++)
+		{
+			TripleBuffer::Frame& frame = _handoff[i]->front();
+			renderer.drawCanvas(layers[i], renderer.width()/2 + frame.position.x, renderer.height()/2 + frame.position.y, frame.scale, frame.scale, 0.0f);
+		}
+		glfwSwapBuffers(renderer.window());
+		return;
+	}
+
 	// Render all layers (Canvas*, xpos, ypos, xscale, yscale, rotation)
 	for (auto& canvas : layers)
 	{
@@ -105,10 +286,91 @@ int Application::run()
 	// Swap buffers
 	glfwSwapBuffers(renderer.window());
 	// glfwPollEvents(); // we do this in input.updateInput()
+}
 
-	return 1;
+void Application::startWorker()
+{
+	for (size_t i = 0; i < layers.size(); i++) {
+		_handoff.push_back(new TripleBuffer());
+	}
+	// the first frame, before the simulation thread takes over the layers
+	publish();
+
+	_stopworker = false;
+	_worker = std::thread(&Application::simulationThread, this);
+}
+
+void Application::stopWorker()
+{
+	if (!_worker.joinable()) {
+		return;
+	}
+	_stopworker = true;
+	_worker.join();
+
+	for (size_t i = 0; i < _handoff.size(); i++) {
+		delete _handoff[i];
+	}
+	_handoff.clear();
+}
+
+void Application::simulationThread()
+{
+	float deltaTime = 0.0f;
+	std::chrono::steady_clock::time_point last = std::chrono::steady_clock::now();
+	while (!_stopworker && !_stop) {
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		deltaTime = std::chrono::duration<float>(now - last).count();
+		last = now;
+
+		// take the input the window collected since last time, and keep it until a step has seen it
+		{
+			std::lock_guard<std::mutex> lock(_inputmutex);
+			_pending.accumulate(_events);
+			_events.clearEvents();
+		}
+		input = _pending;
+
+		int steps = 0;
+		if (this->simulate(deltaTime, &steps)) {
+			publish();
+		}
+		if (steps > 0) {
+			_pending.clearEvents();
+		}
+
+		// nothing to do yet (fixed step rate), don't burn a core on waiting
+		if (steps == 0) {
+			std::this_thread::sleep_for(std::chrono::microseconds(500));
+		}
+	}
 }
 
+void Application::publish()
+{
+	for (size_t i = 0; i < _handoff.size() && i < layers.size(); i++) {
+		Canvas* canvas = layers[i];
+		// same rule as Renderer::renderCanvas: a locked canvas only once after lock()
+		if (canvas->locked() && !canvas->pending()) {
+			continue;
+		}
+		canvas->resolve();
+		_handoff[i]->write(canvas->pixelbuffer, canvas->position, canvas->scale);
+		canvas->consume();
+	}
+}
 
+void Application::composite(rt::PixelBuffer& out)
+{
+	// the dark background from glClearColor()
+	out.fill(rt::RGBAColor(51, 51, 51, 255));
+
+	// same placement as in run()
+	for (auto& canvas : layers)
+	{
+		canvas->resolve();
+		renderer.compositeCanvas(canvas, out, renderer.width()/2 + canvas->position.x, renderer.height()/2 + canvas->position.y, canvas->scale, canvas->scale);
+	}
+}
 
 } // namespace cnv
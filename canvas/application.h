@@ -8,29 +8,85 @@
 #define APPLICATION_H
 
 #include <vector>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 #include <canvas/renderer.h>
 #include <canvas/input.h>
 #include <canvas/canvas.h>
+#include <canvas/triplebuffer.h>
 
 namespace cnv {
 
 class Application
 {
 public:
-	Application(uint16_t width, uint16_t height, uint8_t bitdepth = 24, uint8_t factor = 1);
-	Application(rt::PixelBuffer& pixelbuffer, uint8_t factor = 1, bool setlocked = false);
+	// headless runs update() without a window (also when CANVAS_HEADLESS=1 is set in the environment)
+	Application(uint16_t width, uint16_t height, uint8_t bitdepth = 24, uint8_t factor = 1, bool headless = false);
+	Application(rt::PixelBuffer& pixelbuffer, uint8_t factor = 1, bool setlocked = false, bool headless = false);
 	virtual ~Application();
 
 	int quit();
 	int run();
 	virtual void update(float deltatime) = 0;
 
+	// make quit() return 1. Headless, this is the only way out.
+	void stop() { _stop = true; }
+	bool headless() { return renderer.headless(); }
+	// draw all layers on the CPU into out, like run() does on screen
+	void composite(rt::PixelBuffer& out);
+
+	// Scheduler. By default run() calls update() once and draws once.
+	// With a step rate, update(1/steps) is called steps times per second, or as often as possible with 0 (turbo).
+	// Drawing then happens every n steps and/or at a display rate (fps), or every run() if neither is set.
+	// They can be called from update(), also when it runs on its own thread.
+	void setStepRate(float steps) { _steprate = steps; _restart = true; }
+	void setRenderEvery(int steps) { _renderevery = steps; }
+	void setRenderRate(float fps) { _renderrate = fps; }
+	float stepRate() { return _steprate; }
+
+	// Run update() on its own thread, so drawing and swapping don't wait for it (and it doesn't wait for them).
+	// Each time the scheduler says it's time to draw, the layers are copied into a TripleBuffer for the window.
+	// Create all layers before the first run(), and only touch them from update() after that.
+	void setThreaded(bool threaded) { _threaded = threaded; }
+
 	void hideMouse() { renderer.hideMouse(); }
 	void showMouse() { renderer.showMouse(); }
 
 private:
 	Renderer renderer;
+	std::atomic<bool> _stop;
+
+	// scheduler
+	std::atomic<float> _steprate { -1.0f }; // < 0: not scheduled
+	std::atomic<int> _renderevery { 0 };
+	std::atomic<float> _renderrate { 0.0f };
+	std::atomic<bool> _restart { false }; // the step rate changed: start counting again
+	float _accumulator = 0.0f; // only simulate() touches these
+	int _stepssincerender = 0;
+	std::atomic<int> _stepcounter;
+	std::chrono::steady_clock::time_point _lastrender;
+	std::chrono::steady_clock::time_point _laststep;
+
+	// call update() as scheduled, returns true if it's time to draw
+	bool simulate(float deltatime, int* steps = nullptr);
+	void render();
+
+	// simulation thread
+	bool _threaded = false;
+	std::thread _worker;
+	std::atomic<bool> _stopworker;
+	std::vector<TripleBuffer*> _handoff; // one per layer
+	Input _polled; // updated by the window
+	Input _events; // waiting for a step (for the simulation thread, when threaded)
+	Input _pending; // taken by the simulation thread, until a step has seen them
+	std::mutex _inputmutex;
+	void startWorker();
+	void stopWorker();
+	void simulationThread();
+	void publish();
 
 protected:
 	Input input;
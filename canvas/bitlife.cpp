@@ -0,0 +1,206 @@
+/**
+ * @file bitlife.cpp
+ * @brief cnv::BitLife implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <random>
+
+#include <canvas/bitlife.h>
+#include <canvas/bits.h>
+
+namespace cnv {
+
+BitLife::BitLife(int width, int height, const LifeRule& rule) :
+	_width(width),
+	_height(height),
+	_rule(rule),
+	_generation(0),
+	_current(0)
+{
+	_words = (width + 63) / 64;
+	int used = width % 64;
+	_lastmask = used == 0 ? ~0ULL : (1ULL << used) - 1;
+
+	size_t size = _words * height;
+	_cells[0] = std::vector<uint64_t>(size, 0);
+	_cells[1] = std::vector<uint64_t>(size, 0);
+}
+
+BitLife::~BitLife()
+{
+
+}
+
+uint8_t BitLife::getCell(int x, int y) const
+{
+	rt::vec2i p = rt::wrap(rt::vec2i(x, y), _width, _height);
+	return (row(p.y)[p.x / 64] >> (p.x % 64)) & 1;
+}
+
+void BitLife::setCell(int x, int y, uint8_t state)
+{
+	rt::vec2i p = rt::wrap(rt::vec2i(x, y), _width, _height);
+	uint64_t bit = 1ULL << (p.x % 64);
+	if (state) {
+		row(p.y)[p.x / 64] |= bit;
+	} else {
+		row(p.y)[p.x / 64] &= ~bit;
+	}
+}
+
+uint64_t BitLife::population() const
+{
+	uint64_t count = 0;
+	for (uint64_t word : _cells[_current]) {
+		count += popcount(word);
+	}
+	return count;
+}
+
+void BitLife::clear()
+{
+	std::fill(_cells[_current].begin(), _cells[_current].end(), 0);
+	_generation = 0;
+}
+
+void BitLife::randomize(int percentage, unsigned int seed)
+{
+	// a generator per row: the same universe for the same seed, however many threads
+	parallel_for_rows(_height, [&](const RowBand& band) {
+		for (size_t y = band.begin; y < band.end; y++) {
+			std::mt19937_64 rng(seed + y * 0x9E3779B97F4A7C15ULL);
+			std::uniform_int_distribution<int> dist(0, 99);
+			uint64_t* words = row(y);
+			for (size_t w = 0; w < _words; w++) {
+				uint64_t word = 0;
+				if (percentage == 50) {
+					word = rng();
+				} else {
+					for (int b = 0; b < 64; b++) {
+						if (dist(rng) < percentage) { word |= 1ULL << b; }
+					}
+				}
+				words[w] = word;
+			}
+			words[_words - 1] &= _lastmask;
+		}
+	});
+}
+
+void BitLife::step(int generations)
+{
+	for (int i = 0; i < generations; i++) {
+		parallel_for_rows(_height, [this](const RowBand& band) {
+			stepRows(band);
+		}, _words * sizeof(uint64_t) * 3);
+		_current ^= 1;
+		_generation++;
+	}
+}
+
+// the 3 cells of every bit position in a row: left neighbour, self and right neighbour
+struct Neighbours
+{
+	uint64_t left, self, right;
+};
+
+static inline Neighbours neighbours(const uint64_t* row, size_t w, size_t words, int lastbit)
+{
+	Neighbours n;
+	n.self = row[w];
+	// cell x-1: shift up, bring in the top cell of the word before (or the last cell of the row)
+	uint64_t before = w > 0 ? row[w - 1] >> 63 : (row[words - 1] >> lastbit) & 1;
+	n.left = (n.self << 1) | before;
+	// cell x+1: shift down, bring in the bottom cell of the word after (or the first cell of the row)
+	uint64_t after = w + 1 < words ? row[w + 1] << 63 : (row[0] & 1) << lastbit;
+	n.right = (n.self >> 1) | after;
+	return n;
+}
+
+void BitLife::stepRows(const RowBand& band)
+{
+	const uint64_t* src = _cells[_current].data();
+	uint64_t* dst = _cells[_current ^ 1].data();
+	int lastbit = (_width - 1) % 64;
+
+	// the neighbour counts the rule cares about
+	int birth[9], survive[9];
+	int births = 0, survives = 0;
+	for (int n = 0; n < 9; n++) {
+		if (_rule.birth[n]) { birth[births++] = n; }
+		if (_rule.survive[n]) { survive[survives++] = n; }
+	}
+
+	for (size_t y = band.begin; y < band.end; y++) {
+		const uint64_t* above = src + band.above(y) * _words;
+		const uint64_t* middle = src + y * _words;
+		const uint64_t* below = src + band.below(y) * _words;
+		uint64_t* out = dst + y * _words;
+
+		for (size_t w = 0; w < _words; w++) {
+			Neighbours a = neighbours(above, w, _words, lastbit);
+			Neighbours m = neighbours(middle, w, _words, lastbit);
+			Neighbours b = neighbours(below, w, _words, lastbit);
+
+			// above and below: 3 cells each, into 2 bits (full adders)
+			uint64_t a0 = a.left ^ a.self ^ a.right;
+			uint64_t a1 = (a.left & a.self) | (a.right & (a.left ^ a.self));
+			uint64_t b0 = b.left ^ b.self ^ b.right;
+			uint64_t b1 = (b.left & b.self) | (b.right & (b.left ^ b.self));
+			// middle: 2 cells, into 2 bits (half adder)
+			uint64_t m0 = m.left ^ m.right;
+			uint64_t m1 = m.left & m.right;
+
+			// add the three 2 bit numbers into count = s0 + 2*s1 + 4*s2 + 8*s3
+			uint64_t s0 = a0 ^ b0 ^ m0;
+			uint64_t c0 = (a0 & b0) | (m0 & (a0 ^ b0)); // carry into the 2s
+			uint64_t t = a1 ^ b1 ^ m1;
+			uint64_t c1 = (a1 & b1) | (m1 & (a1 ^ b1)); // carry into the 4s
+			uint64_t s1 = t ^ c0;
+			uint64_t c2 = t & c0; // carry into the 4s
+			uint64_t s2 = c1 ^ c2;
+			uint64_t s3 = c1 & c2;
+
+			// cells with exactly n neighbours
+			uint64_t count[4][2] = { {~s0, s0}, {~s1, s1}, {~s2, s2}, {~s3, s3} };
+			uint64_t born = 0;
+			for (int i = 0; i < births; i++) {
+				int n = birth[i];
+				born |= count[0][n & 1] & count[1][(n >> 1) & 1] & count[2][(n >> 2) & 1] & count[3][n >> 3];
+			}
+			uint64_t stay = 0;
+			for (int i = 0; i < survives; i++) {
+				int n = survive[i];
+				stay |= count[0][n & 1] & count[1][(n >> 1) & 1] & count[2][(n >> 2) & 1] & count[3][n >> 3];
+			}
+
+			out[w] = (born & ~m.self) | (stay & m.self);
+		}
+		// keep the cells past the width dead
+		out[_words - 1] &= _lastmask;
+	}
+}
+
+void BitLife::render(rt::PixelBuffer& pixelbuffer, int left, int top, const rt::RGBAColor& alive, const rt::RGBAColor& dead) const
+{
+	int cols = pixelbuffer.width();
+	int rows = pixelbuffer.height();
+	std::vector<rt::RGBAColor>& pixels = pixelbuffer.pixels();
+
+	parallel_for_rows(rows, [&](const RowBand& band) {
+		for (size_t y = band.begin; y < band.end; y++) {
+			int cy = ((top + (int)y) % _height + _height) % _height;
+			const uint64_t* words = row(cy);
+			rt::RGBAColor* out = &pixels[y * cols];
+			int cx = ((left % _width) + _width) % _width;
+			for (int x = 0; x < cols; x++) {
+				out[x] = ((words[cx / 64] >> (cx % 64)) & 1) ? alive : dead;
+				cx++;
+				if (cx == _width) { cx = 0; }
+			}
+		}
+	});
+}
+
+} // namespace cnv
@@ -0,0 +1,85 @@
+/**
+ * @file bitlife.h
+ * @brief cnv::BitLife header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef BITLIFE_H
+#define BITLIFE_H
+
+#include <cstdint>
+#include <vector>
+
+#include <pixelbuffer/pixelbuffer.h>
+
+#include <canvas/life.h>
+#include <canvas/parallel.h>
+
+namespace cnv {
+
+/// @brief Runs a 2 state life-like rule on a toroidal grid, 64 cells per uint64_t.
+/// Neighbours of 64 cells are counted at once with bitwise adders into 4 bit planes, and the rule
+/// picks the counts it needs from them. A cell costs one bit, so very large universes fit in memory;
+/// only the part you look at is turned into pixels with render().
+class BitLife
+{
+public:
+	/// @brief an empty (dead) universe
+	/// @param width width, any size
+	/// @param height height
+	/// @param rule the rule, Generations states are ignored
+	BitLife(int width, int height, const LifeRule& rule = LifeRule());
+	virtual ~BitLife();
+
+	int width() const { return _width; }
+	int height() const { return _height; }
+	/// @brief number of steps since construction (or clear())
+	uint64_t generation() const { return _generation; }
+
+	const LifeRule& rule() const { return _rule; }
+	void setRule(const LifeRule& rule) { _rule = rule; }
+
+	/// @brief state of a cell (0 or 1), wraps around
+	uint8_t getCell(int x, int y) const;
+	/// @brief set a cell alive (1) or dead (0), wraps around
+	void setCell(int x, int y, uint8_t state);
+	/// @brief number of cells alive
+	uint64_t population() const;
+
+	/// @brief everything dead, generation 0
+	void clear();
+	/// @brief every cell alive with a chance of percentage
+	void randomize(int percentage, unsigned int seed);
+
+	/// @brief advance
+	/// @param generations number of generations
+	void step(int generations = 1);
+
+	/// @brief write a window of the universe into a pixelbuffer, the size of the pixelbuffer
+	/// @param pixelbuffer the pixelbuffer
+	/// @param left left of the window, wraps around
+	/// @param top top of the window, wraps around
+	/// @param alive color of living cells
+	/// @param dead color of dead cells
+	void render(rt::PixelBuffer& pixelbuffer, int left, int top, const rt::RGBAColor& alive, const rt::RGBAColor& dead) const;
+
+private:
+	int _width;
+	int _height;
+	size_t _words; // per row
+	uint64_t _lastmask; // cells in use in the last word of a row
+	LifeRule _rule;
+	uint64_t _generation;
+
+	// double buffered, _cells[_current] is now
+	std::vector<uint64_t> _cells[2];
+	int _current;
+
+	void stepRows(const RowBand& band);
+	uint64_t* row(int y) { return &_cells[_current][y * _words]; }
+	const uint64_t* row(int y) const { return &_cells[_current][y * _words]; }
+};
+
+} // namespace cnv
+
+#endif /* BITLIFE_H */
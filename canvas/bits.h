@@ -0,0 +1,54 @@
+/**
+ * @file bits.h
+ * @brief cnv::popcount, cnv::lowestbit
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef BITS_H
+#define BITS_H
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace cnv {
+
+/// @brief number of bits that are set
+inline int popcount(uint64_t bits)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_popcountll(bits);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	return (int)__popcnt64(bits);
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+	return (int)_CountOneBits64(bits);
+#else
+	// add up pairs, nibbles, then bytes
+	bits = bits - ((bits >> 1) & 0x5555555555555555ULL);
+	bits = (bits & 0x3333333333333333ULL) + ((bits >> 2) & 0x3333333333333333ULL);
+	bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (int)((bits * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/// @brief index of the lowest bit that is set
+/// @param bits not 0
+inline int lowestbit(uint64_t bits)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctzll(bits);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+	unsigned long index;
+	_BitScanForward64(&index, bits);
+	return (int)index;
+#else
+	// the bits below the lowest one
+	return popcount((bits & (~bits + 1)) - 1);
+#endif
+}
+
+} // namespace cnv
+
+#endif /* BITS_H */
@@ -6,6 +6,8 @@
 
 #include <iostream>
 #include <cstdio>
+#include <cstring>
+#include <algorithm>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -20,36 +22,35 @@ Canvas::Canvas(uint16_t width, uint16_t height, uint8_t bitdepth /* = 32 */, uin
 	pixelbuffer(width, height, bitdepth), scale(scale), position(rt::vec2i(0, 0))
 {
 	// pixelbuffer = { width, height, bitdepth };
-	generateGeometry(width, height); // _vertexbuffer & _uvbuffer
-	generateTexture(); // _texture
+	// _texture, _vertexbuffer & _uvbuffer are created on the first updateTexture()
 }
 
 Canvas::Canvas(const rt::PixelBuffer& pb) : pixelbuffer(pb)
 {
 	// pixelbuffer = pb;
-	generateGeometry(pixelbuffer.width(), pixelbuffer.height()); // _vertexbuffer & _uvbuffer
-	generateTexture(); // _texture
 }
 
 Canvas::Canvas(const std::string& imagepath)
 {
 	pixelbuffer.read(imagepath);
-	generateGeometry(pixelbuffer.width(), pixelbuffer.height()); // _vertexbuffer & _uvbuffer
-	generateTexture(); // _texture
 }
 
 Canvas::~Canvas()
 {
-	glDeleteBuffers(1, &_vertexbuffer); // mesh created in generateGeometry() with glGenBuffers()
-	glDeleteBuffers(1, &_uvbuffer);
-	glDeleteTextures(1, &_texture); // texture created in generateTexture() with glGenTextures()
+	if (_texture != 0) {
+		glDeleteBuffers(1, &_vertexbuffer); // mesh created in generateGeometry() with glGenBuffers()
+		glDeleteBuffers(1, &_uvbuffer);
+		glDeleteTextures(1, &_texture); // texture created in generateTexture() with glGenTextures()
+	}
 }
 
 int Canvas::generateGeometry(int width, int height)
 {
 	// delete what we have
-	glDeleteBuffers(1, &_vertexbuffer);
-	glDeleteBuffers(1, &_uvbuffer);
+	if (_vertexbuffer != 0) {
+		glDeleteBuffers(1, &_vertexbuffer);
+		glDeleteBuffers(1, &_uvbuffer);
+	}
 
 	// Our vertices. Tree consecutive floats give a 3D vertex; Three consecutive vertices give a triangle.
 	// A sprite has 1 face (quad) with 2 triangles each, so this makes 1*2=2 triangles, and 2*3 vertices
@@ -86,9 +87,17 @@ int Canvas::generateGeometry(int width, int height)
 }
 
 GLuint Canvas::generateTexture()
+{
+	_dirty.clear();
+	return generateTexture(pixelbuffer.pixels(), pixelbuffer.width(), pixelbuffer.height());
+}
+
+GLuint Canvas::generateTexture(const std::vector<rt::RGBAColor>& data, int width, int height)
 {
 	// delete what we have
-	glDeleteTextures(1, &_texture);
+	if (_texture != 0) {
+		glDeleteTextures(1, &_texture);
+	}
 
 	// Create one OpenGL texture
 	// Be sure to also delete it from where you called this with glDeleteTextures()
@@ -106,17 +115,155 @@ GLuint Canvas::generateTexture()
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-	auto data = pixelbuffer.pixels();
-	size_t width = pixelbuffer.width();
-	size_t height = pixelbuffer.height();
-
 	// all our pixelbuffers are RGBA colors (so handle alpha)
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	glEnable(GL_BLEND);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, &data[0]);
 
+	// this is what's on the GPU now
+	_uploaded = data;
+	_texwidth = width;
+	_texheight = height;
+
 	// Return the ID of the texture we just created
 	return _texture;
 }
 
+void Canvas::markDirty(int x, int y, int w, int h)
+{
+	// clip to the pixelbuffer
+	int cols = pixelbuffer.width();
+	int rows = pixelbuffer.height();
+	if (x < 0) { w += x; x = 0; }
+	if (y < 0) { h += y; y = 0; }
+	if (x + w > cols) { w = cols - x; }
+	if (y + h > rows) { h = rows - y; }
+	if (w <= 0 || h <= 0) {
+		return;
+	}
+
+	// too many small rectangles cost more in glTexSubImage2D calls than they save. Merge them.
+	const size_t maxrects = 16;
+	if (_dirty.size() >= maxrects) {
+		Rect merged = { x, y, w, h };
+		for (size_t i = 0; i < _dirty.size(); i++) {
+			int right = std::max(merged.x + merged.w, _dirty[i].x + _dirty[i].w);
+			int bottom = std::max(merged.y + merged.h, _dirty[i].y + _dirty[i].h);
+			merged.x = std::min(merged.x, _dirty[i].x);
+			merged.y = std::min(merged.y, _dirty[i].y);
+			merged.w = right - merged.x;
+			merged.h = bottom - merged.y;
+		}
+		_dirty.clear();
+		_dirty.push_back(merged);
+		return;
+	}
+
+	Rect rect = { x, y, w, h };
+	_dirty.push_back(rect);
+}
+
+size_t Canvas::updateTexture()
+{
+	resolve();
+	_pending = false;
+	size_t uploaded = upload(pixelbuffer.pixels(), pixelbuffer.width(), pixelbuffer.height(), !_dirty.empty());
+	_dirty.clear();
+	return uploaded;
+}
+
+size_t Canvas::updateTexture(const std::vector<rt::RGBAColor>& data, int width, int height)
+{
+	// the marks and the lock belong to our pixelbuffer (maybe in another thread), don't touch them
+	return upload(data, width, height, false);
+}
+
+size_t Canvas::upload(const std::vector<rt::RGBAColor>& data, int width, int height, bool marked)
+{
+	// first time, or pb->read("file.pbf") changed the size: (re)create everything
+	if (_texture == 0 || _texwidth != width || _texheight != height) {
+		generateTexture(data, width, height);
+		generateGeometry(width, height);
+		return data.size();
+	}
+
+	glBindTexture(GL_TEXTURE_2D, _texture);
+
+	// upload straight from the pixels, skipping what we don't need
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, _texwidth);
+	size_t uploaded = marked ? uploadMarked(data) : uploadChanged(data);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+	glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+
+	return uploaded;
+}
+
+size_t Canvas::uploadRect(const std::vector<rt::RGBAColor>& data, const Rect& rect)
+{
+	glPixelStorei(GL_UNPACK_SKIP_PIXELS, rect.x);
+	glPixelStorei(GL_UNPACK_SKIP_ROWS, rect.y);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x, rect.y, rect.w, rect.h, GL_RGBA, GL_UNSIGNED_BYTE, &data[0]);
+
+	return rect.w * rect.h;
+}
+
+size_t Canvas::uploadMarked(const std::vector<rt::RGBAColor>& data)
+{
+	size_t uploaded = 0;
+	for (size_t i = 0; i < _dirty.size(); i++) {
+		const Rect& rect = _dirty[i];
+		uploaded += uploadRect(data, rect);
+
+		// keep our copy in sync
+		for (int y = rect.y; y < rect.y + rect.h; y++) {
+			size_t start = y * _texwidth + rect.x;
+			std::copy(data.begin() + start, data.begin() + start + rect.w, _uploaded.begin() + start);
+		}
+	}
+
+	return uploaded;
+}
+
+size_t Canvas::uploadChanged(const std::vector<rt::RGBAColor>& data)
+{
+	size_t uploaded = 0;
+	size_t rowbytes = _texwidth * sizeof(rt::RGBAColor);
+
+	// grow a rectangle over consecutive changed rows, upload it when an unchanged row is found
+	Rect rect = { 0, 0, 0, 0 };
+	int right = 0;
+	for (int y = 0; y <= _texheight; y++) {
+		size_t start = y * _texwidth;
+		bool changed = y < _texheight && memcmp(&data[start], &_uploaded[start], rowbytes) != 0;
+		if (!changed) {
+			if (rect.h > 0) {
+				rect.w = right - rect.x;
+				uploaded += uploadRect(data, rect);
+				rect.h = 0;
+			}
+			continue;
+		}
+
+		// find the changed span in this row
+		int first = 0;
+		while (memcmp(&data[start + first], &_uploaded[start + first], sizeof(rt::RGBAColor)) == 0) { first++; }
+		int last = _texwidth - 1;
+		while (memcmp(&data[start + last], &_uploaded[start + last], sizeof(rt::RGBAColor)) == 0) { last--; }
+		std::copy(data.begin() + start + first, data.begin() + start + last + 1, _uploaded.begin() + start + first);
+
+		if (rect.h == 0) {
+			rect.x = first;
+			rect.y = y;
+			right = last + 1;
+		} else {
+			rect.x = std::min(rect.x, first);
+			right = std::max(right, last + 1);
+		}
+		rect.h++;
+	}
+
+	return uploaded;
+}
+
 } // namespace cnv
@@ -8,6 +8,7 @@
 #define CANVAS_H
 
 #include <string>
+#include <vector>
 
 #include <GL/glew.h>
 
@@ -31,11 +32,38 @@ class Canvas
 		uint16_t height() { return pixelbuffer.height(); };
 
 		GLuint generateTexture();
+		GLuint generateTexture(const std::vector<rt::RGBAColor>& data, int width, int height);
 		int generateGeometry(int width, int height);
 
-		// lock regenerates the texture after you're done with the pixels for the renderer to keep drawing
-		void lock() { _locked = true; generateTexture(); generateGeometry(width(), height()); }
+		/// @brief Mark a region of the pixelbuffer as changed.
+		/// When regions are marked, only those are uploaded and the pixels are not compared.
+		/// @param x left
+		/// @param y top
+		/// @param w width
+		/// @param h height
+		void markDirty(int x, int y, int w, int h);
+		/// @brief Upload the changed pixels to the texture.
+		/// Creates the texture and geometry the first time, or when the size of the pixelbuffer changed.
+		/// @return number of pixels uploaded
+		size_t updateTexture();
+		/// @brief Upload the changed pixels to the texture, from somewhere other than our pixelbuffer.
+		/// Ignores (and keeps) markDirty() regions and the lock.
+		/// @param data pixels
+		/// @param width width of data
+		/// @param height height of data
+		/// @return number of pixels uploaded
+		size_t updateTexture(const std::vector<rt::RGBAColor>& data, int width, int height);
+		/// @brief Called right before the pixelbuffer is uploaded by updateTexture(), handed to the render thread,
+		/// or drawn by Application::composite() (and after update() when there's no window).
+		/// Override it to fill the pixelbuffer from something else (see TrailCanvas).
+		virtual void resolve() { }
+
+		// lock uploads the changed pixels once after you're done with them, for the renderer to keep drawing
+		void lock() { _locked = true; _pending = true; }
 		bool locked() { return _locked; }
+		bool pending() { return _pending; }
+		// the pixels were handed to someone else to upload: forget pending uploads and marks
+		void consume() { _pending = false; _dirty.clear(); }
 
 	public:
 		rt::PixelBuffer pixelbuffer;
@@ -43,11 +71,30 @@ class Canvas
 		rt::vec2i position;
 
 	private:
-		GLuint _texture;
-		GLuint _vertexbuffer;
-		GLuint _uvbuffer;
+		struct Rect
+		{
+			int x, y, w, h;
+		};
+
+		GLuint _texture = 0;
+		GLuint _vertexbuffer = 0;
+		GLuint _uvbuffer = 0;
 
 		bool _locked = false;
+		bool _pending = false;
+
+		// size of what's on the GPU
+		int _texwidth = 0;
+		int _texheight = 0;
+		// copy of what's on the GPU, to find the pixels that changed
+		std::vector<rt::RGBAColor> _uploaded;
+		// regions marked with markDirty()
+		std::vector<Rect> _dirty;
+
+		size_t upload(const std::vector<rt::RGBAColor>& data, int width, int height, bool marked);
+		size_t uploadRect(const std::vector<rt::RGBAColor>& data, const Rect& rect);
+		size_t uploadMarked(const std::vector<rt::RGBAColor>& data);
+		size_t uploadChanged(const std::vector<rt::RGBAColor>& data);
 };
 
 } // namespace cnv
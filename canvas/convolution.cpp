@@ -0,0 +1,184 @@
+/**
+ * @file convolution.cpp
+ * @brief cnv::ConvolutionEngine implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <algorithm>
+#include <random>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <canvas/convolution.h>
+
+namespace cnv {
+
+ConvolutionEngine::ConvolutionEngine(int width, int height, int size) :
+	_width(width),
+	_height(height),
+	_current(0)
+{
+	_size = size == 5 ? 5 : 3;
+	_pad = _size / 2;
+	_stride = width + 2 * _pad;
+
+	size_t padded = _stride * (height + 2 * _pad);
+	_fields[0] = std::vector<float>(padded, 0.0f);
+	_fields[1] = std::vector<float>(padded, 0.0f);
+
+	// identity
+	_kernel = std::vector<float>(_size * _size, 0.0f);
+	_kernel[_size * _size / 2] = 1.0f;
+}
+
+ConvolutionEngine::~ConvolutionEngine()
+{
+
+}
+
+void ConvolutionEngine::setKernel(const float* weights)
+{
+	_kernel.assign(weights, weights + _size * _size);
+}
+
+void ConvolutionEngine::setKernel(rt::mat3 filter)
+{
+	float weights[25] = { 0 };
+	for (int r = 0; r < 3; r++) {
+		// a 3x3 filter in the middle of a 5x5 kernel
+		int k = (r + _pad - 1) * _size + (_pad - 1);
+		weights[k + 0] = filter[r].x;
+		weights[k + 1] = filter[r].y;
+		weights[k + 2] = filter[r].z;
+	}
+	setKernel(weights);
+}
+
+float ConvolutionEngine::get(int x, int y) const
+{
+	rt::vec2i p = rt::wrap(rt::vec2i(x, y), _width, _height);
+	return *cell(_fields[_current], p.x, p.y);
+}
+
+void ConvolutionEngine::set(int x, int y, float value)
+{
+	rt::vec2i p = rt::wrap(rt::vec2i(x, y), _width, _height);
+	*cell(_fields[_current], p.x, p.y) = value;
+}
+
+void ConvolutionEngine::randomize(unsigned int seed)
+{
+	std::mt19937 rng(seed);
+	for (int y = 0; y < _height; y++) {
+		float* row = cell(_fields[_current], 0, y);
+		for (int x = 0; x < _width; x++) {
+			row[x] = rng() & 1;
+		}
+	}
+}
+
+void ConvolutionEngine::pad()
+{
+	std::vector<float>& field = _fields[_current];
+	int p = _pad;
+
+	// left and right: the other side of the row
+	for (int y = 0; y < _height; y++) {
+		float* row = cell(field, 0, y);
+		for (int i = 1; i <= p; i++) {
+			row[-i] = row[_width - i];
+			row[_width - 1 + i] = row[i - 1];
+		}
+	}
+	// top and bottom: the other side of the field, padding included
+	for (int i = 1; i <= p; i++) {
+		std::copy(cell(field, -p, _height - i), cell(field, -p, _height - i) + _stride, cell(field, -p, -i));
+		std::copy(cell(field, -p, i - 1), cell(field, -p, i - 1) + _stride, cell(field, -p, _height - 1 + i));
+	}
+}
+
+void ConvolutionEngine::convolveRow(int y, float* out) const
+{
+	const std::vector<float>& field = _fields[_current];
+
+	// the taps that count: where to read (for x = 0) and how much
+	const float* sources[25];
+	float weights[25];
+	int taps = 0;
+	for (int ky = 0; ky < _size; ky++) {
+		for (int kx = 0; kx < _size; kx++) {
+			float weight = _kernel[ky * _size + kx];
+			if (weight != 0.0f) {
+				sources[taps] = cell(field, kx - _pad, y + ky - _pad);
+				weights[taps] = weight;
+				taps++;
+			}
+		}
+	}
+
+	int x = 0;
+#ifdef __SSE2__
+	__m128 w[25];
+	for (int t = 0; t < taps; t++) {
+		w[t] = _mm_set1_ps(weights[t]);
+	}
+	for (; x + 4 <= _width; x += 4) {
+		__m128 sum = _mm_setzero_ps();
+		for (int t = 0; t < taps; t++) {
+			sum = _mm_add_ps(sum, _mm_mul_ps(w[t], _mm_loadu_ps(sources[t] + x)));
+		}
+		_mm_storeu_ps(out + x, sum);
+	}
+#endif
+	for (; x < _width; x++) {
+		float sum = 0.0f;
+		for (int t = 0; t < taps; t++) {
+			sum += weights[t] * sources[t][x];
+		}
+		out[x] = sum;
+	}
+}
+
+void ConvolutionEngine::step(const std::function<void(float* values, size_t count)>& activation)
+{
+	pad();
+
+	std::vector<float>& next = _fields[_current ^ 1];
+	parallel_for_rows(_height, [&](const RowBand& band) {
+		for (size_t y = band.begin; y < band.end; y++) {
+			float* out = cell(next, 0, y);
+			convolveRow(y, out);
+			// while the row is still in cache
+			if (activation) {
+				activation(out, _width);
+			}
+		}
+	}, _stride * sizeof(float) * _size);
+
+	_current ^= 1;
+}
+
+void ConvolutionEngine::render(rt::PixelBuffer& pixelbuffer) const
+{
+	if (pixelbuffer.width() != _width || pixelbuffer.height() != _height) {
+		return;
+	}
+
+	std::vector<rt::RGBAColor>& pixels = pixelbuffer.pixels();
+	parallel_for_rows(_height, [&](const RowBand& band) {
+		for (size_t y = band.begin; y < band.end; y++) {
+			const float* row = cell(_fields[_current], 0, y);
+			rt::RGBAColor* out = &pixels[y * _width];
+			for (int x = 0; x < _width; x++) {
+				// map from 0-1 to 0-255
+				float value = std::min(1.0f, std::max(0.0f, row[x]));
+				uint8_t gray = value * 255;
+				out[x] = rt::RGBAColor(gray, gray, gray, 255);
+			}
+		}
+	});
+}
+
+} // namespace cnv
@@ -0,0 +1,77 @@
+/**
+ * @file convolution.h
+ * @brief cnv::ConvolutionEngine header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef CONVOLUTION_H
+#define CONVOLUTION_H
+
+#include <functional>
+#include <vector>
+
+#include <pixelbuffer/pixelbuffer.h>
+#include <pixelbuffer/math/mat3.h>
+
+#include <canvas/parallel.h>
+
+namespace cnv {
+
+/// @brief Convolves a toroidal field of floats with a 3x3 or 5x5 kernel, and activates the result.
+/// The field is padded with a copy of the opposite edges, so the kernel never has to wrap,
+/// and double buffered. Rows are convolved 4 floats at a time (SSE2) in bands on the ThreadPool.
+class ConvolutionEngine
+{
+public:
+	/// @brief a field of zeros, and a kernel that does nothing
+	/// @param width width
+	/// @param height height
+	/// @param size kernel size, 3 or 5
+	ConvolutionEngine(int width, int height, int size = 3);
+	virtual ~ConvolutionEngine();
+
+	int width() const { return _width; }
+	int height() const { return _height; }
+	int size() const { return _size; }
+
+	/// @brief set the weights
+	/// @param weights size*size weights, row by row
+	void setKernel(const float* weights);
+	/// @brief set the weights of a 3x3 kernel
+	/// @param filter the filter
+	void setKernel(rt::mat3 filter);
+
+	/// @brief value of a cell, wraps around
+	float get(int x, int y) const;
+	/// @brief set the value of a cell, wraps around
+	void set(int x, int y, float value);
+	/// @brief every cell 0 or 1
+	void randomize(unsigned int seed);
+
+	/// @brief convolve every cell, and activate
+	/// @param activation called with a row of convolved values at a time, to change in place. Can be empty.
+	void step(const std::function<void(float* values, size_t count)>& activation);
+
+	/// @brief write the field into a pixelbuffer of the same size, 0 .. 1 as black .. white
+	void render(rt::PixelBuffer& pixelbuffer) const;
+
+private:
+	int _width;
+	int _height;
+	int _size;
+	int _pad; // cells around the field
+	int _stride; // floats per row, padding included
+
+	std::vector<float> _kernel;
+	std::vector<float> _fields[2];
+	int _current;
+
+	float* cell(std::vector<float>& field, int x, int y) { return &field[(y + _pad) * _stride + x + _pad]; }
+	const float* cell(const std::vector<float>& field, int x, int y) const { return &field[(y + _pad) * _stride + x + _pad]; }
+	void pad();
+	void convolveRow(int y, float* out) const;
+};
+
+} // namespace cnv
+
+#endif /* CONVOLUTION_H */
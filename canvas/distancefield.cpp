@@ -0,0 +1,288 @@
+/**
+ * @file distancefield.cpp
+ * @brief cnv::DistanceField implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <algorithm>
+#include <mutex>
+
+#include <canvas/bits.h>
+#include <canvas/distancefield.h>
+#include <canvas/parallel.h>
+
+namespace cnv {
+
+const uint32_t DistanceField::UNREACHABLE;
+
+DistanceField::DistanceField(const GridMap& map) :
+	_width(map.width()),
+	_height(map.height()),
+	_rowwords((map.width() + 63) / 64),
+	_visited(_rowwords * map.height()),
+	_frontier(_rowwords * map.height()),
+	_next(_rowwords * map.height()),
+	_maximum(0),
+	_topdown(0),
+	_bottomup(0)
+{
+	_open = std::vector<uint64_t>(_rowwords * _height, 0);
+	_distance = std::vector<uint32_t>((size_t)_width * _height, UNREACHABLE);
+	parallel_for(_height, [&](size_t begin, size_t end) {
+		for (size_t y = begin; y < end; y++) {
+			uint64_t* row = &_open[y * _rowwords];
+			for (int x = 0; x < _width; x++) {
+				if (!map.wall(map.index(x, y))) {
+					row[x / 64] |= (uint64_t)1 << (x % 64);
+				}
+			}
+		}
+	});
+
+	for (int i = 0; i < 256; i++) {
+		rt::HSVAColor hsva = rt::RGBA2HSVA(RED);
+		hsva.h = i / 256.0f * 0.8f; // red .. purple
+		hsva.s = 1;
+		hsva.v = 1;
+		_palette.push_back(rt::HSVA2RGBA(hsva));
+	}
+}
+
+DistanceField::~DistanceField()
+{
+
+}
+
+size_t DistanceField::compute(rt::vec2i source)
+{
+	return compute(std::vector<rt::vec2i>(1, source));
+}
+
+size_t DistanceField::compute(const std::vector<rt::vec2i>& sources)
+{
+	size_t words = _visited.size();
+	parallel_for(words, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			_visited[i].store(0, std::memory_order_relaxed);
+			_frontier[i].store(0, std::memory_order_relaxed);
+			_next[i].store(0, std::memory_order_relaxed);
+		}
+	}, 65536);
+	parallel_for(_distance.size(), [&](size_t begin, size_t end) {
+		std::fill(_distance.begin() + begin, _distance.begin() + end, UNREACHABLE);
+	}, 262144);
+	_maximum = 0;
+	_topdown = 0;
+	_bottomup = 0;
+
+	// level 0
+	_queue.clear();
+	int top = _height;
+	int bottom = -1;
+	for (size_t i = 0; i < sources.size(); i++) {
+		int x = sources[i].x;
+		int y = sources[i].y;
+		if (x < 0 || y < 0 || x >= _width || y >= _height) { continue; }
+		size_t word = y * _rowwords + x / 64;
+		uint64_t bit = (uint64_t)1 << (x % 64);
+		if (!(_open[word] & bit) || (_visited[word].load() & bit)) { continue; }
+		_visited[word].fetch_or(bit);
+		_distance[(size_t)y * _width + x] = 0;
+		_queue.push_back((size_t)y * _width + x);
+		top = std::min(top, y);
+		bottom = std::max(bottom, y);
+	}
+
+	size_t count = _queue.size();
+	size_t reached = count;
+	bool bitmap = false; // the frontier is in _frontier, not in _queue
+	uint32_t level = 0;
+	while (count > 0) {
+		_maximum = level;
+		level++;
+
+		// a cell of the frontier costs top-down about what two words cost bottom-up
+		int first = _height;
+		int last = -1;
+		size_t rows = bottom - top + 3;
+		if (count * 2 > rows * _rowwords) {
+			if (!bitmap) {
+				toBitmap();
+				bitmap = true;
+			}
+			count = expandBottomUp(level, top, bottom, first, last);
+			_bottomup++;
+
+			// the old frontier is the next empty one
+			parallel_for(bottom - top + 1, [&](size_t begin, size_t end) {
+				for (size_t i = (top + begin) * _rowwords; i < (top + end) * _rowwords; i++) {
+					_frontier[i].store(0, std::memory_order_relaxed);
+				}
+			}, std::max((size_t)1, 4096 / _rowwords));
+			_frontier.swap(_next);
+		} else {
+			if (bitmap) {
+				toQueue(top, bottom);
+				bitmap = false;
+			}
+			count = expandTopDown(level, first, last);
+			_topdown++;
+			_queue.swap(_nextqueue);
+		}
+		reached += count;
+		top = first;
+		bottom = last;
+	}
+	return reached;
+}
+
+size_t DistanceField::expandTopDown(uint32_t level, int& first, int& last)
+{
+	_nextqueue.clear();
+	std::mutex mutex;
+	// small frontiers stay on this thread
+	parallel_for(_queue.size(), [&](size_t begin, size_t end) {
+		std::vector<size_t> found;
+		int lo = _height;
+		int hi = -1;
+		// mark an open, unvisited neighbour, if no other thread did it first
+		auto mark = [&](int x, int y) {
+			size_t word = y * _rowwords + x / 64;
+			uint64_t bit = (uint64_t)1 << (x % 64);
+			if (!(_open[word] & bit) || (_visited[word].load(std::memory_order_relaxed) & bit)) { return; }
+			if (_visited[word].fetch_or(bit, std::memory_order_relaxed) & bit) { return; }
+			size_t i = (size_t)y * _width + x;
+			_distance[i] = level;
+			found.push_back(i);
+			lo = std::min(lo, y);
+			hi = std::max(hi, y);
+		};
+
+		for (size_t i = begin; i < end; i++) {
+			int x = _queue[i] % _width;
+			int y = _queue[i] / _width;
+			if (y > 0) { mark(x, y - 1); }
+			if (x < _width - 1) { mark(x + 1, y); }
+			if (y < _height - 1) { mark(x, y + 1); }
+			if (x > 0) { mark(x - 1, y); }
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		_nextqueue.insert(_nextqueue.end(), found.begin(), found.end());
+		first = std::min(first, lo);
+		last = std::max(last, hi);
+	}, 1024);
+	return _nextqueue.size();
+}
+
+void DistanceField::toBitmap()
+{
+	parallel_for(_queue.size(), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			size_t x = _queue[i] % _width;
+			size_t y = _queue[i] / _width;
+			_frontier[y * _rowwords + x / 64].fetch_or((uint64_t)1 << (x % 64), std::memory_order_relaxed);
+		}
+	}, 4096);
+	_queue.clear();
+}
+
+void DistanceField::toQueue(int top, int bottom)
+{
+	_queue.clear();
+	if (bottom < top) {
+		return;
+	}
+	std::mutex mutex;
+	parallel_for(bottom - top + 1, [&](size_t begin, size_t end) {
+		std::vector<size_t> found;
+		for (size_t y = top + begin; y < top + end; y++) {
+			for (size_t w = 0; w < _rowwords; w++) {
+				uint64_t bits = _frontier[y * _rowwords + w].exchange(0, std::memory_order_relaxed);
+				while (bits) {
+					found.push_back(y * _width + w * 64 + lowestbit(bits));
+					bits &= bits - 1;
+				}
+			}
+		}
+		std::lock_guard<std::mutex> lock(mutex);
+		_queue.insert(_queue.end(), found.begin(), found.end());
+	}, std::max((size_t)1, 4096 / _rowwords));
+}
+
+size_t DistanceField::expandBottomUp(uint32_t level, int top, int bottom, int& first, int& last)
+{
+	// the rows next to the frontier too
+	int from = std::max(top - 1, 0);
+	int to = std::min(bottom + 1, _height - 1);
+
+	std::mutex mutex;
+	size_t found = 0;
+	parallel_for(to - from + 1, [&](size_t begin, size_t end) {
+		size_t count = 0;
+		int lo = _height;
+		int hi = -1;
+		for (int y = from + begin; y < from + (int)end; y++) {
+			const std::atomic<uint64_t>* row = &_frontier[y * _rowwords];
+			const std::atomic<uint64_t>* up = y > 0 ? row - _rowwords : nullptr;
+			const std::atomic<uint64_t>* down = y < _height - 1 ? row + _rowwords : nullptr;
+			for (size_t w = 0; w < _rowwords; w++) {
+				uint64_t f = row[w].load(std::memory_order_relaxed);
+				uint64_t left = w > 0 ? row[w - 1].load(std::memory_order_relaxed) : 0;
+				uint64_t right = w + 1 < _rowwords ? row[w + 1].load(std::memory_order_relaxed) : 0;
+				// cells with a neighbour in the frontier: left of them, right of them, above, below
+				uint64_t near = (f << 1) | (left >> 63) | (f >> 1) | (right << 63);
+				if (up != nullptr) { near |= up[w].load(std::memory_order_relaxed); }
+				if (down != nullptr) { near |= down[w].load(std::memory_order_relaxed); }
+
+				// only this thread writes this word
+				size_t word = y * _rowwords + w;
+				uint64_t visited = _visited[word].load(std::memory_order_relaxed);
+				uint64_t bits = near & _open[word] & ~visited;
+				if (!bits) { continue; }
+				_visited[word].store(visited | bits, std::memory_order_relaxed);
+				_next[word].store(bits, std::memory_order_relaxed);
+				lo = std::min(lo, y);
+				hi = std::max(hi, y);
+				while (bits) {
+					size_t x = w * 64 + lowestbit(bits);
+					bits &= bits - 1;
+					_distance[(size_t)y * _width + x] = level;
+					count++;
+				}
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		found += count;
+		first = std::min(first, lo);
+		last = std::max(last, hi);
+	}, std::max((size_t)1, 4096 / _rowwords));
+	return found;
+}
+
+void DistanceField::render(rt::PixelBuffer& pixelbuffer) const
+{
+	if (pixelbuffer.width() != _width || pixelbuffer.height() != _height) {
+		return;
+	}
+	std::vector<rt::RGBAColor>& pixels = pixelbuffer.pixels();
+	uint32_t maximum = std::max(_maximum, (uint32_t)1);
+	parallel_for(_height, [&](size_t begin, size_t end) {
+		for (size_t y = begin; y < end; y++) {
+			for (int x = 0; x < _width; x++) {
+				size_t i = y * _width + x;
+				uint32_t distance = _distance[i];
+				if (!((_open[y * _rowwords + x / 64] >> (x % 64)) & 1)) {
+					pixels[i] = BLACK;
+				} else if (distance == UNREACHABLE) {
+					pixels[i] = GRAY;
+				} else {
+					pixels[i] = _palette[(uint64_t)distance * 255 / maximum];
+				}
+			}
+		}
+	});
+}
+
+} // namespace cnv
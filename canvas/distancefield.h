@@ -0,0 +1,85 @@
+/**
+ * @file distancefield.h
+ * @brief cnv::DistanceField header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef DISTANCEFIELD_H
+#define DISTANCEFIELD_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <pixelbuffer/pixelbuffer.h>
+
+#include <canvas/gridmap.h>
+
+namespace cnv {
+
+/// @brief The number of steps (up, down, left, right) from the nearest source to every open cell of a GridMap.
+/// A breadth first search, a level at a time on the ThreadPool. Every level goes the cheapest way:
+/// - top-down: every cell of a small frontier (a list) marks its unvisited neighbours (atomic visited bits)
+/// - bottom-up: for every word of the rows around a big frontier (a bitmap, rows padded to 64 bits),
+///   the unvisited open cells with a neighbour in the frontier, 64 cells at a time
+class DistanceField
+{
+public:
+	/// @brief not reached (a wall, or closed off)
+	static const uint32_t UNREACHABLE = 0xFFFFFFFF;
+
+	/// @param map the grid, it's not copied, but its walls are: change the map, make a new DistanceField
+	DistanceField(const GridMap& map);
+	virtual ~DistanceField();
+
+	/// @brief distances from one cell
+	/// @return number of cells reached
+	size_t compute(rt::vec2i source);
+	/// @brief distances from the nearest of the sources
+	/// @return number of cells reached
+	size_t compute(const std::vector<rt::vec2i>& sources);
+
+	uint32_t at(int x, int y) const { return _distance[(size_t)y * _width + x]; }
+	/// @brief distance of every cell, row after row
+	const std::vector<uint32_t>& distances() const { return _distance; }
+	/// @brief the largest distance
+	uint32_t maximum() const { return _maximum; }
+	/// @brief levels that went top-down and bottom-up in the last compute()
+	size_t topdown() const { return _topdown; }
+	size_t bottomup() const { return _bottomup; }
+
+	/// @brief color every cell by its distance, walls BLACK, unreachable cells GRAY
+	/// @param pixelbuffer the size of the map
+	void render(rt::PixelBuffer& pixelbuffer) const;
+
+private:
+	int _width;
+	int _height;
+	size_t _rowwords; // words per row
+	std::vector<uint64_t> _open; // padded rows
+	std::vector<std::atomic<uint64_t>> _visited;
+	std::vector<std::atomic<uint64_t>> _frontier; // bottom-up
+	std::vector<std::atomic<uint64_t>> _next;
+	std::vector<size_t> _queue; // top-down
+	std::vector<size_t> _nextqueue;
+	std::vector<uint32_t> _distance;
+	uint32_t _maximum;
+	size_t _topdown;
+	size_t _bottomup;
+
+	std::vector<rt::RGBAColor> _palette;
+
+	/// @brief find the next level from _queue, into _nextqueue
+	/// @return cells found, and the rows they're in
+	size_t expandTopDown(uint32_t level, int& first, int& last);
+	/// @brief find the next level from the rows top .. bottom of _frontier, into _next
+	/// @return cells found, and the rows they're in
+	size_t expandBottomUp(uint32_t level, int top, int bottom, int& first, int& last);
+	/// @brief from one kind of frontier to the other, for the rows top .. bottom
+	void toBitmap();
+	void toQueue(int top, int bottom);
+};
+
+} // namespace cnv
+
+#endif /* DISTANCEFIELD_H */
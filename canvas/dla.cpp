@@ -0,0 +1,211 @@
+/**
+ * @file dla.cpp
+ * @brief cnv::DLAEngine implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include <canvas/dla.h>
+#include <canvas/parallel.h>
+
+namespace cnv {
+
+static const int LAUNCH = 4; // walkers start this far outside of the cluster radius
+static const int JUMPS = 256; // per walker, per round
+static const size_t GROWTH = 1024; // a walker for every this many particles in the cluster
+
+const int DLAEngine::MAXDISTANCE;
+
+static inline uint32_t xorshift(uint32_t& state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+static inline int round_to_int(float v)
+{
+	return v < 0.0f ? (int)(v - 0.5f) : (int)(v + 0.5f);
+}
+
+DLAEngine::DLAEngine(int width, int height, size_t walkers, unsigned int seed) :
+	_cols(width),
+	_rows(height),
+	_centerx(width / 2),
+	_centery(height / 2),
+	_radius(0.0f),
+	_active(0)
+{
+	// at least one walker, or step() never gets anywhere
+	walkers = std::max(walkers, (size_t)1);
+	_bits = std::vector<uint64_t>((_cols * _rows + 63) / 64, 0);
+	_distance = std::vector<uint8_t>(_cols * _rows, MAXDISTANCE);
+
+	_wx = std::vector<int>(walkers, 0);
+	_wy = std::vector<int>(walkers, 0);
+	_wrng = std::vector<uint32_t>(walkers, 0);
+	_touching = std::vector<uint8_t>(walkers, 0);
+	for (size_t w = 0; w < walkers; w++) {
+		_wrng[w] = (seed + 1) * 2654435761u ^ (w + 1) * 40503u;
+		if (_wrng[w] == 0) { _wrng[w] = 1; }
+	}
+
+	for (int i = 0; i < 256; i++) {
+		float angle = i * 2.0f * 3.14159265f / 256;
+		_unit[i][0] = std::cos(angle);
+		_unit[i][1] = std::sin(angle);
+	}
+
+	reset(_centerx, _centery);
+}
+
+DLAEngine::~DLAEngine()
+{
+
+}
+
+void DLAEngine::reset(int x, int y)
+{
+	std::fill(_bits.begin(), _bits.end(), 0);
+	std::fill(_distance.begin(), _distance.end(), MAXDISTANCE);
+	_particles.clear();
+	_centerx = std::min(std::max(x, 0), _cols - 1);
+	_centery = std::min(std::max(y, 0), _rows - 1);
+	_radius = 0.0f;
+	stick(_centerx, _centery);
+	_active = 0;
+}
+
+bool DLAEngine::done() const
+{
+	int room = std::min(std::min(_centerx, _centery), std::min(_cols - 1 - _centerx, _rows - 1 - _centery));
+	return _radius + LAUNCH + 2 >= room;
+}
+
+bool DLAEngine::occupied(int x, int y) const
+{
+	if (x < 0 || y < 0 || x >= _cols || y >= _rows) {
+		return false;
+	}
+	size_t index = y * _cols + x;
+	return (_bits[index / 64] >> (index % 64)) & 1;
+}
+
+void DLAEngine::launch(size_t walker)
+{
+	const float* unit = _unit[xorshift(_wrng[walker]) >> 24];
+	float r = _radius + LAUNCH;
+	_wx[walker] = _centerx + round_to_int(unit[0] * r);
+	_wy[walker] = _centery + round_to_int(unit[1] * r);
+	_touching[walker] = 0;
+}
+
+void DLAEngine::walk(size_t walker)
+{
+	int& x = _wx[walker];
+	int& y = _wy[walker];
+	float kill = _radius * 3 + 32;
+
+	for (int j = 0; j < JUMPS; j++) {
+		int distance = _distance[y * _cols + x];
+		if (distance <= 1) {
+			_touching[walker] = 1;
+			return;
+		}
+
+		// nothing within distance-1, in any direction
+		int jump = distance - 1;
+		if (distance == MAXDISTANCE) {
+			// nothing closer than the cluster radius either
+			float dx = x - _centerx;
+			float dy = y - _centery;
+			float r = std::sqrt(dx * dx + dy * dy);
+			if (r > kill) {
+				launch(walker);
+				continue;
+			}
+			jump = std::max(jump, (int)(r - _radius) - 2);
+		}
+
+		const float* unit = _unit[xorshift(_wrng[walker]) >> 24];
+		x += round_to_int(unit[0] * jump);
+		y += round_to_int(unit[1] * jump);
+		if (x < 0 || y < 0 || x >= _cols || y >= _rows) {
+			launch(walker);
+		}
+	}
+}
+
+void DLAEngine::stick(int x, int y)
+{
+	size_t index = y * _cols + x;
+	_bits[index / 64] |= (uint64_t)1 << (index % 64);
+	_particles.push_back(index);
+
+	float dx = x - _centerx;
+	float dy = y - _centery;
+	_radius = std::max(_radius, std::sqrt(dx * dx + dy * dy));
+
+	// a square of Chebyshev distances around it
+	int left = std::max(x - (MAXDISTANCE - 1), 0);
+	int right = std::min(x + (MAXDISTANCE - 1), _cols - 1);
+	int top = std::max(y - (MAXDISTANCE - 1), 0);
+	int bottom = std::min(y + (MAXDISTANCE - 1), _rows - 1);
+	for (int ny = top; ny <= bottom; ny++) {
+		uint8_t* row = &_distance[ny * _cols];
+		int ry = std::abs(ny - y);
+		for (int nx = left; nx <= right; nx++) {
+			uint8_t d = std::max(std::abs(nx - x), ry);
+			row[nx] = std::min(row[nx], d);
+		}
+	}
+}
+
+size_t DLAEngine::step(size_t particles)
+{
+	size_t stuck = 0;
+	while (stuck < particles && !done()) {
+		// all walkers see the cluster as it was at the start of the round. With many of them around a
+		// small cluster, that's a different (compact) kind of growth, so they join in as the cluster grows.
+		size_t active = std::min(_wx.size(), 1 + _particles.size() / GROWTH);
+		for (size_t w = _active; w < active; w++) {
+			launch(w);
+		}
+		_active = active;
+
+		// walk
+		parallel_for(_active, [this](size_t begin, size_t end) {
+			for (size_t w = begin; w < end; w++) {
+				if (!_touching[w]) {
+					walk(w);
+				}
+			}
+		}, 16);
+
+		// stick, one by one: a walker may be on a cell that just filled up
+		for (size_t w = 0; w < _active && stuck < particles && !done(); w++) {
+			if (!_touching[w]) {
+				continue;
+			}
+			if (!occupied(_wx[w], _wy[w])) {
+				stick(_wx[w], _wy[w]);
+				stuck++;
+			}
+			launch(w);
+		}
+	}
+	return stuck;
+}
+
+void DLAEngine::render(rt::PixelBuffer& pixelbuffer, const rt::RGBAColor& color, size_t from) const
+{
+	for (size_t i = from; i < _particles.size(); i++) {
+		pixelbuffer.setPixel(_particles[i] % _cols, _particles[i] / _cols, color);
+	}
+}
+
+} // namespace cnv
@@ -0,0 +1,94 @@
+/**
+ * @file dla.h
+ * @brief cnv::DLAEngine header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef DLA_H
+#define DLA_H
+
+#include <cstdint>
+#include <vector>
+
+#include <pixelbuffer/pixelbuffer.h>
+
+namespace cnv {
+
+/// @brief Diffusion-limited aggregation: random walkers stick to a growing cluster.
+/// The cluster is a bitmap, with a map of the (Chebyshev) distance to it, capped at MAXDISTANCE.
+/// Walkers start on a circle just outside the cluster, and jump as far as they can without
+/// touching it: (distance - 1) in the map, or past the cluster radius when that's further.
+/// Walkers move in parallel rounds (each with its own random numbers), then stick one by one.
+/// There are only as many walkers as the cluster is big enough for (one per 1024 particles), so they
+/// hardly ever see a cluster that's out of date, and it grows like it would with one walker at a time.
+class DLAEngine
+{
+public:
+	/// @brief distances in the map go up to this
+	static const int MAXDISTANCE = 16;
+
+	/// @brief an empty field, with a particle at the center
+	/// @param width width of the field
+	/// @param height height of the field
+	/// @param walkers most walkers at the same time (at least 1)
+	/// @param seed for the walkers
+	DLAEngine(int width, int height, size_t walkers = 4096, unsigned int seed = 0);
+	virtual ~DLAEngine();
+
+	int width() const { return _cols; }
+	int height() const { return _rows; }
+
+	/// @brief start over with a single particle
+	/// @param x the center of the cluster
+	/// @param y the center of the cluster
+	void reset(int x, int y);
+
+	/// @brief let walkers stick to the cluster
+	/// @param particles stick this many, or until the cluster is done()
+	/// @return number of particles that stuck
+	size_t step(size_t particles);
+	/// @brief the cluster can't grow: its launch circle doesn't fit in the field
+	bool done() const;
+
+	/// @brief number of particles in the cluster
+	size_t count() const { return _particles.size(); }
+	/// @brief distance of the furthest particle from the center
+	float radius() const { return _radius; }
+	/// @brief the particles in the order they stuck
+	rt::vec2i particle(size_t index) const { return rt::vec2i(_particles[index] % _cols, _particles[index] / _cols); }
+	bool occupied(int x, int y) const;
+
+	/// @brief draw the particles from `from` on
+	/// @param pixelbuffer to draw in
+	/// @param color of the particles
+	/// @param from first particle
+	void render(rt::PixelBuffer& pixelbuffer, const rt::RGBAColor& color, size_t from = 0) const;
+
+private:
+	int _cols;
+	int _rows;
+	int _centerx;
+	int _centery;
+	float _radius;
+
+	std::vector<uint64_t> _bits; // occupied cells
+	std::vector<uint8_t> _distance; // to the nearest occupied cell, MAXDISTANCE at most
+	std::vector<uint32_t> _particles; // cells, in the order they stuck
+
+	// the walkers
+	std::vector<int> _wx;
+	std::vector<int> _wy;
+	std::vector<uint32_t> _wrng;
+	std::vector<uint8_t> _touching; // next to the cluster, after a round
+	size_t _active; // walkers in use
+
+	float _unit[256][2]; // random directions
+
+	void launch(size_t walker);
+	void walk(size_t walker);
+	void stick(int x, int y);
+};
+
+} // namespace cnv
+
+#endif /* DLA_H */
@@ -0,0 +1,111 @@
+/**
+ * @file elementary.cpp
+ * @brief cnv::ElementaryCA implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <algorithm>
+
+#include <canvas/elementary.h>
+
+namespace cnv {
+
+ElementaryCA::ElementaryCA(int width, uint8_t rule) :
+	_width(width),
+	_rule(rule)
+{
+	size_t words = (width + 63) / 64;
+	_row = std::vector<uint64_t>(words, 0);
+	_next = std::vector<uint64_t>(words, 0);
+
+	// everything but the first and the last cell
+	_inside = std::vector<uint64_t>(words, 0);
+	for (int x = 1; x < width - 1; x++) {
+		_inside[x / 64] |= 1ULL << (x % 64);
+	}
+}
+
+ElementaryCA::~ElementaryCA()
+{
+
+}
+
+uint8_t ElementaryCA::getCell(int x) const
+{
+	if (x < 0 || x >= _width) {
+		return 0;
+	}
+	return (_row[x / 64] >> (x % 64)) & 1;
+}
+
+void ElementaryCA::setCell(int x, uint8_t state)
+{
+	if (x < 0 || x >= _width) {
+		return;
+	}
+	uint64_t bit = 1ULL << (x % 64);
+	if (state) {
+		_row[x / 64] |= bit;
+	} else {
+		_row[x / 64] &= ~bit;
+	}
+}
+
+void ElementaryCA::clear()
+{
+	std::fill(_row.begin(), _row.end(), 0);
+}
+
+void ElementaryCA::randomize(std::mt19937& rng)
+{
+	for (size_t w = 0; w < _row.size(); w++) {
+		uint64_t word = ((uint64_t)rng() << 32) | rng();
+		_row[w] = word;
+	}
+	// nothing past the last cell
+	int used = _width % 64;
+	if (used != 0) {
+		_row.back() &= (1ULL << used) - 1;
+	}
+}
+
+void ElementaryCA::step()
+{
+	size_t words = _row.size();
+	for (size_t w = 0; w < words; w++) {
+		uint64_t c = _row[w];
+		// left neighbour of every cell (cell x-1), and right neighbour (cell x+1)
+		uint64_t l = (c << 1) | (w > 0 ? _row[w - 1] >> 63 : 0);
+		uint64_t r = (c >> 1) | (w + 1 < words ? _row[w + 1] << 63 : 0);
+
+		// the rule has a bit for each of the 8 neighbourhoods: index = l*4 + c*2 + r
+		uint64_t out = 0;
+		for (int i = 0; i < 8; i++) {
+			if ((_rule >> i) & 1) {
+				out |= ((i & 4) ? l : ~l) & ((i & 2) ? c : ~c) & ((i & 1) ? r : ~r);
+			}
+		}
+		_next[w] = out & _inside[w];
+	}
+	_row.swap(_next);
+}
+
+void ElementaryCA::render(rt::PixelBuffer& pixelbuffer, const rt::RGBAColor& alive, const rt::RGBAColor& dead)
+{
+	int cols = pixelbuffer.width();
+	int rows = pixelbuffer.height();
+	if (cols != _width) {
+		return;
+	}
+
+	std::vector<rt::RGBAColor>& pixels = pixelbuffer.pixels();
+	for (int y = 0; y < rows; y++) {
+		rt::RGBAColor* out = &pixels[y * cols];
+		for (int x = 0; x < cols; x++) {
+			out[x] = ((_row[x / 64] >> (x % 64)) & 1) ? alive : dead;
+		}
+		step();
+	}
+}
+
+} // namespace cnv
@@ -0,0 +1,64 @@
+/**
+ * @file elementary.h
+ * @brief cnv::ElementaryCA header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef ELEMENTARY_H
+#define ELEMENTARY_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <pixelbuffer/pixelbuffer.h>
+
+namespace cnv {
+
+/// @brief A Wolfram elementary cellular automaton, one row of cells, 64 cells per uint64_t.
+/// Every cell looks at itself and its left and right neighbour, for all 64 cells of a word at once.
+/// The first and last cell of the row stay dead (there's nothing past them to look at).
+class ElementaryCA
+{
+public:
+	/// @brief a dead row
+	/// @param width number of cells
+	/// @param rule rule number 0 .. 255
+	ElementaryCA(int width, uint8_t rule);
+	virtual ~ElementaryCA();
+
+	int width() const { return _width; }
+	uint8_t rule() const { return _rule; }
+	void setRule(uint8_t rule) { _rule = rule; }
+
+	/// @brief state of a cell (0 or 1), 0 outside the row
+	uint8_t getCell(int x) const;
+	/// @brief set a cell alive (1) or dead (0)
+	void setCell(int x, uint8_t state);
+
+	/// @brief all cells dead
+	void clear();
+	/// @brief every cell (edges included) alive or dead, 50/50
+	void randomize(std::mt19937& rng);
+
+	/// @brief the next row
+	void step();
+
+	/// @brief the current row and the ones after it, top to bottom, one per row of the pixelbuffer.
+	/// After this, the row is the one after the bottom row.
+	/// @param pixelbuffer the pixelbuffer, as wide as the row
+	/// @param alive color of living cells
+	/// @param dead color of dead cells
+	void render(rt::PixelBuffer& pixelbuffer, const rt::RGBAColor& alive, const rt::RGBAColor& dead);
+
+private:
+	int _width;
+	uint8_t _rule;
+	std::vector<uint64_t> _row;
+	std::vector<uint64_t> _next;
+	std::vector<uint64_t> _inside; // cells that have 2 neighbours
+};
+
+} // namespace cnv
+
+#endif /* ELEMENTARY_H */
@@ -0,0 +1,212 @@
+/**
+ * @file fft.cpp
+ * @brief cnv::FFT, cnv::RealFFT2D implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <cmath>
+
+#include <canvas/fft.h>
+#include <canvas/parallel.h>
+
+namespace cnv {
+
+typedef std::complex<float> cpx;
+
+// FFT
+FFT::FFT(int size) :
+	_size(size)
+{
+	// factors: 2s first, then odd numbers (that are primes by then)
+	int n = size;
+	int p = 2;
+	do {
+		while (n % p != 0) {
+			p = p == 2 ? 3 : p + 2;
+			if (p * p > n) { p = n; }
+		}
+		n /= p;
+		_factors.push_back(p);
+		_factors.push_back(n);
+	} while (n > 1);
+
+	_forward.resize(size);
+	_inverse.resize(size);
+	for (int i = 0; i < size; i++) {
+		double angle = -2.0 * M_PI * i / size;
+		_forward[i] = cpx(std::cos(angle), std::sin(angle));
+		_inverse[i] = std::conj(_forward[i]);
+	}
+}
+
+FFT::~FFT()
+{
+
+}
+
+void FFT::forward(const cpx* in, cpx* out, int stride) const
+{
+	work(out, in, 1, stride, _factors.data(), _forward.data());
+}
+
+void FFT::inverse(const cpx* in, cpx* out, int stride) const
+{
+	work(out, in, 1, stride, _factors.data(), _inverse.data());
+}
+
+void FFT::work(cpx* out, const cpx* in, int fstride, int stride, const int* factors, const cpx* twiddles) const
+{
+	// decimation in time: p transforms of length m, then combine them
+	const int p = factors[0];
+	const int m = factors[1];
+	if (m == 1) {
+		for (int k = 0; k < p; k++) {
+			out[k] = in[k * fstride * stride];
+		}
+	} else {
+		for (int q = 0; q < p; q++) {
+			work(out + q * m, in + q * fstride * stride, fstride * p, stride, factors + 2, twiddles);
+		}
+	}
+	butterfly(out, fstride, m, p, twiddles);
+}
+
+void FFT::butterfly(cpx* out, int fstride, int m, int p, const cpx* twiddles) const
+{
+	if (p == 2) {
+		for (int k = 0; k < m; k++) {
+			cpx t = out[m + k] * twiddles[k * fstride];
+			out[m + k] = out[k] - t;
+			out[k] += t;
+		}
+		return;
+	}
+
+	// any radix: a small DFT of every p values, with the twiddles folded in.
+	// The plan is shared by threads, so the values go in scratch space of the thread, that only ever grows.
+	static thread_local std::vector<cpx> scratch;
+	if (scratch.size() < (size_t)p) {
+		scratch.resize(p);
+	}
+	for (int u = 0; u < m; u++) {
+		for (int q = 0, k = u; q < p; q++, k += m) {
+			scratch[q] = out[k];
+		}
+		for (int q1 = 0, k = u; q1 < p; q1++, k += m) {
+			int twiddle = 0;
+			cpx sum = scratch[0];
+			for (int q = 1; q < p; q++) {
+				twiddle += fstride * k;
+				if (twiddle >= _size) { twiddle -= _size; }
+				sum += scratch[q] * twiddles[twiddle];
+			}
+			out[k] = sum;
+		}
+	}
+}
+
+// RealFFT2D
+RealFFT2D::RealFFT2D(int width, int height) :
+	_width(width),
+	_height(height),
+	_columns(width / 2 + 1),
+	_rows(width),
+	_cols(height)
+{
+
+}
+
+RealFFT2D::~RealFFT2D()
+{
+
+}
+
+void RealFFT2D::forward(const float* field, cpx* spectrum) const
+{
+	int W = _width;
+	int H = _height;
+	int C = _columns;
+
+	// rows, two real rows as one complex row
+	parallel_for((H + 1) / 2, [&](size_t begin, size_t end) {
+		std::vector<cpx> z(W);
+		std::vector<cpx> Z(W);
+		for (size_t pair = begin; pair < end; pair++) {
+			int y0 = pair * 2;
+			int y1 = y0 + 1;
+			for (int x = 0; x < W; x++) {
+				z[x] = cpx(field[y0 * W + x], y1 < H ? field[y1 * W + x] : 0.0f);
+			}
+			_rows.forward(z.data(), Z.data());
+
+			// and apart again: the even part is row y0, the odd part row y1
+			for (int k = 0; k < C; k++) {
+				cpx a = Z[k];
+				cpx b = std::conj(Z[(W - k) % W]);
+				spectrum[y0 * C + k] = (a + b) * 0.5f;
+				if (y1 < H) {
+					spectrum[y1 * C + k] = (a - b) * cpx(0.0f, -0.5f);
+				}
+			}
+		}
+	});
+
+	// columns
+	parallel_for(C, [&](size_t begin, size_t end) {
+		std::vector<cpx> column(H);
+		for (size_t k = begin; k < end; k++) {
+			_cols.forward(spectrum + k, column.data(), C);
+			for (int y = 0; y < H; y++) {
+				spectrum[y * C + k] = column[y];
+			}
+		}
+	});
+}
+
+void RealFFT2D::inverse(cpx* spectrum, float* field) const
+{
+	int W = _width;
+	int H = _height;
+	int C = _columns;
+	float scale = 1.0f / ((float)W * H);
+
+	// columns
+	parallel_for(C, [&](size_t begin, size_t end) {
+		std::vector<cpx> column(H);
+		for (size_t k = begin; k < end; k++) {
+			_cols.inverse(spectrum + k, column.data(), C);
+			for (int y = 0; y < H; y++) {
+				spectrum[y * C + k] = column[y];
+			}
+		}
+	});
+
+	// rows: the mirrored half of the spectrum of a real row is the conjugate
+	parallel_for((H + 1) / 2, [&](size_t begin, size_t end) {
+		std::vector<cpx> z(W);
+		std::vector<cpx> Z(W);
+		for (size_t pair = begin; pair < end; pair++) {
+			int y0 = pair * 2;
+			int y1 = y0 + 1;
+			const cpx* a = spectrum + y0 * C;
+			const cpx* b = y1 < H ? spectrum + y1 * C : nullptr;
+			for (int x = 0; x < W; x++) {
+				cpx ax = x < C ? a[x] : std::conj(a[W - x]);
+				cpx bx = 0.0f;
+				if (b != nullptr) {
+					bx = x < C ? b[x] : std::conj(b[W - x]);
+				}
+				z[x] = ax + cpx(0.0f, 1.0f) * bx;
+			}
+			_rows.inverse(z.data(), Z.data());
+			for (int x = 0; x < W; x++) {
+				field[y0 * W + x] = Z[x].real() * scale;
+				if (y1 < H) {
+					field[y1 * W + x] = Z[x].imag() * scale;
+				}
+			}
+		}
+	});
+}
+
+} // namespace cnv
@@ -0,0 +1,81 @@
+/**
+ * @file fft.h
+ * @brief cnv::FFT, cnv::RealFFT2D header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef FFT_H
+#define FFT_H
+
+#include <complex>
+#include <vector>
+
+namespace cnv {
+
+/// @brief A complex FFT of any length (mixed radix, fastest for lengths made of 2, 3 and 5).
+/// The plan is read only after construction, so one FFT can be used by many threads at once.
+class FFT
+{
+public:
+	/// @brief plan a transform
+	/// @param size number of values
+	FFT(int size);
+	virtual ~FFT();
+
+	int size() const { return _size; }
+
+	/// @brief out = FFT(in), not scaled
+	/// @param in size values, stride apart
+	/// @param out size values
+	/// @param stride distance between values of in
+	void forward(const std::complex<float>* in, std::complex<float>* out, int stride = 1) const;
+	/// @brief out = inverse FFT(in), not scaled (divide by size yourself)
+	void inverse(const std::complex<float>* in, std::complex<float>* out, int stride = 1) const;
+
+private:
+	int _size;
+	std::vector<int> _factors; // radix, remaining length, radix, remaining length, ...
+	std::vector<std::complex<float>> _forward; // twiddles
+	std::vector<std::complex<float>> _inverse;
+
+	void work(std::complex<float>* out, const std::complex<float>* in, int fstride, int stride, const int* factors, const std::complex<float>* twiddles) const;
+	void butterfly(std::complex<float>* out, int fstride, int m, int p, const std::complex<float>* twiddles) const;
+};
+
+/// @brief A 2D FFT of real values (a field of floats).
+/// Two rows are transformed as one complex row, and only the width/2+1 columns that aren't
+/// mirror images are kept and transformed. Rows and columns run on the ThreadPool.
+class RealFFT2D
+{
+public:
+	/// @brief plan a transform
+	/// @param width width of the field
+	/// @param height height of the field
+	RealFFT2D(int width, int height);
+	virtual ~RealFFT2D();
+
+	int width() const { return _width; }
+	int height() const { return _height; }
+	/// @brief number of values in a spectrum: (width/2+1) * height
+	size_t spectrumSize() const { return (size_t)_columns * _height; }
+
+	/// @brief spectrum = FFT(field)
+	/// @param field width*height values, row by row
+	/// @param spectrum spectrumSize() values, row by row
+	void forward(const float* field, std::complex<float>* spectrum) const;
+	/// @brief field = inverse FFT(spectrum), scaled (so forward then inverse gives back the field)
+	/// @param spectrum spectrumSize() values, changed
+	/// @param field width*height values, row by row
+	void inverse(std::complex<float>* spectrum, float* field) const;
+
+private:
+	int _width;
+	int _height;
+	int _columns; // width/2+1
+	FFT _rows;
+	FFT _cols;
+};
+
+} // namespace cnv
+
+#endif /* FFT_H */
@@ -0,0 +1,150 @@
+/**
+ * @file flowfield.cpp
+ * @brief cnv::FlowField implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <canvas/flowfield.h>
+
+namespace cnv {
+
+FlowField::FlowField(const PerlinNoise& noise, int cols, int rows, const std::vector<PerlinNoise::Octave>& octaves, Mode mode) :
+	_noise(noise),
+	_octaves(octaves),
+	_cols(cols),
+	_rows(rows),
+	_mode(mode)
+{
+	_values = std::vector<float>((cols + 2) * (rows + 2), 0.0f);
+	_scratch = std::vector<float>(cols * rows, 0.0f);
+	_field = std::vector<rt::vec2f>(cols * rows, rt::vec2f(0.0f, 0.0f));
+}
+
+FlowField::~FlowField()
+{
+
+}
+
+void FlowField::update(float z)
+{
+	// The field wraps around, so the noise has to as well. Every value is a blend of the noise there, and of
+	// the noise a field further left, up, and both: at the right edge it's (all but) the noise left of the left
+	// edge, at the bottom the noise above the top.
+	float dx = 1.0f / _cols;
+	float dy = 1.0f / _rows;
+	std::fill(_values.begin(), _values.end(), 0.0f);
+	for (int shift = 0; shift < 4; shift++) {
+		int sx = shift & 1;
+		int sy = shift >> 1;
+		_noise.fillGrid(_scratch.data(), _cols, _rows, (0.5f - sx * _cols) * dx, dx, (0.5f - sy * _rows) * dy, dy, z, _octaves, false);
+		for (int y = 0; y < _rows; y++) {
+			float v = (y + 0.5f) * dy;
+			float wy = sy ? v : 1.0f - v;
+			for (int x = 0; x < _cols; x++) {
+				float u = (x + 0.5f) * dx;
+				float wx = sx ? u : 1.0f - u;
+				_values[(y + 1) * (_cols + 2) + x + 1] += wx * wy * _scratch[y * _cols + x];
+			}
+		}
+	}
+
+	// the ring is the other side, for the slopes at the edges
+	for (int x = 0; x < _cols; x++) {
+		_values[x + 1] = value(x, _rows - 1);
+		_values[(_rows + 1) * (_cols + 2) + x + 1] = value(x, 0);
+	}
+	for (int y = -1; y <= _rows; y++) {
+		_values[(y + 1) * (_cols + 2)] = value(_cols - 1, y);
+		_values[(y + 1) * (_cols + 2) + _cols + 1] = value(0, y);
+	}
+
+	if (_mode == ANGLE) {
+		float min = 1.0f;
+		float max = 0.0f;
+		for (int y = 0; y < _rows; y++) {
+			for (int x = 0; x < _cols; x++) {
+				min = std::min(min, value(x, y));
+				max = std::max(max, value(x, y));
+			}
+		}
+		if (max <= min) {
+			max = min + 1.0f;
+		}
+		for (int y = 0; y < _rows; y++) {
+			for (int x = 0; x < _cols; x++) {
+				float angle = rt::map(value(x, y), min, max, -3.1415926f*1.9f, 3.1415926f*1.9f);
+				_field[y * _cols + x] = rt::vec2f::fromAngle(angle);
+			}
+		}
+		return;
+	}
+
+	// CURL: (d/dy, -d/dx), central differences
+	float longest = 0.0f;
+	for (int y = 0; y < _rows; y++) {
+		for (int x = 0; x < _cols; x++) {
+			rt::vec2f v;
+			v.x = (value(x, y + 1) - value(x, y - 1)) * 0.5f;
+			v.y = -(value(x + 1, y) - value(x - 1, y)) * 0.5f;
+			_field[y * _cols + x] = v;
+			longest = std::max(longest, v.x * v.x + v.y * v.y);
+		}
+	}
+	// the fastest is 1
+	if (longest > 0.0f) {
+		float scale = 1.0f / std::sqrt(longest);
+		for (size_t i = 0; i < _field.size(); i++) {
+			_field[i].x *= scale;
+			_field[i].y *= scale;
+		}
+	}
+}
+
+rt::vec2f FlowField::at(int x, int y) const
+{
+	rt::vec2i p = rt::wrap(rt::vec2i(x, y), _cols, _rows);
+	return _field[p.y * _cols + p.x];
+}
+
+rt::vec2f FlowField::sample(float x, float y) const
+{
+	// relative to the centers of the cells
+	x -= 0.5f;
+	y -= 0.5f;
+	float fx = std::floor(x);
+	float fy = std::floor(y);
+	float tx = x - fx;
+	float ty = y - fy;
+	int ix = fx;
+	int iy = fy;
+
+	rt::vec2f a = at(ix, iy);
+	rt::vec2f b = at(ix + 1, iy);
+	rt::vec2f c = at(ix, iy + 1);
+	rt::vec2f d = at(ix + 1, iy + 1);
+
+	rt::vec2f v;
+	v.x = (a.x + (b.x - a.x) * tx) * (1 - ty) + (c.x + (d.x - c.x) * tx) * ty;
+	v.y = (a.y + (b.y - a.y) * tx) * (1 - ty) + (c.y + (d.y - c.y) * tx) * ty;
+	return v;
+}
+
+void FlowField::render(rt::PixelBuffer& pixelbuffer) const
+{
+	if (pixelbuffer.width() != _cols || pixelbuffer.height() != _rows) {
+		return;
+	}
+
+	std::vector<rt::RGBAColor>& pixels = pixelbuffer.pixels();
+	for (int y = 0; y < _rows; y++) {
+		for (int x = 0; x < _cols; x++) {
+			uint8_t gray = std::min(1.0f, std::max(0.0f, value(x, y))) * 255;
+			pixels[y * _cols + x] = rt::RGBAColor(gray, gray, gray, 255);
+		}
+	}
+}
+
+} // namespace cnv
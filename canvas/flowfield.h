@@ -0,0 +1,74 @@
+/**
+ * @file flowfield.h
+ * @brief cnv::FlowField header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+#include <vector>
+
+#include <pixelbuffer/pixelbuffer.h>
+
+#include <canvas/noise.h>
+
+namespace cnv {
+
+/// @brief A toroidal field of vectors from noise, with a vector per cell.
+/// Noise is only evaluated at the center of every cell (blended so it wraps around too),
+/// and in between the vectors are interpolated.
+class FlowField
+{
+public:
+	enum Mode
+	{
+		ANGLE, // noise from min to max turns the vector almost twice around
+		CURL // perpendicular to the slope of the noise: no sources or sinks, things flow around
+	};
+
+	/// @brief the field covers 0.0 - 1.0 of the noise in x and y (and -1.0 - 0.0, to wrap around)
+	/// @param noise the noise (copied)
+	/// @param cols number of cells in x
+	/// @param rows number of cells in y
+	/// @param octaves the octaves
+	/// @param mode ANGLE or CURL
+	FlowField(const PerlinNoise& noise, int cols, int rows, const std::vector<PerlinNoise::Octave>& octaves, Mode mode = ANGLE);
+	virtual ~FlowField();
+
+	int cols() const { return _cols; }
+	int rows() const { return _rows; }
+	Mode mode() const { return _mode; }
+	void setMode(Mode mode) { _mode = mode; }
+
+	/// @brief evaluate the noise, and the vectors
+	/// @param z z of the noise
+	void update(float z);
+
+	/// @brief vector of a cell (length 1 for ANGLE, up to 1 for CURL), wraps around
+	rt::vec2f at(int x, int y) const;
+	/// @brief vector anywhere, bilinear between the centers of the cells, wraps around
+	/// @param x x in cells (cell 0 goes from 0.0 to 1.0)
+	/// @param y y in cells
+	rt::vec2f sample(float x, float y) const;
+
+	/// @brief write the noise into a pixelbuffer of cols x rows, as gray
+	void render(rt::PixelBuffer& pixelbuffer) const;
+
+private:
+	PerlinNoise _noise;
+	std::vector<PerlinNoise::Octave> _octaves;
+	int _cols;
+	int _rows;
+	Mode _mode;
+
+	std::vector<float> _values; // (cols+2) x (rows+2): the cells and a ring around them
+	std::vector<float> _scratch; // cols x rows: noise, before blending
+	std::vector<rt::vec2f> _field;
+
+	float value(int x, int y) const { return _values[(y + 1) * (_cols + 2) + x + 1]; }
+};
+
+} // namespace cnv
+
+#endif /* FLOWFIELD_H */
@@ -0,0 +1,126 @@
+/**
+ * @file gridmap.cpp
+ * @brief cnv::GridMap implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <cctype>
+#include <climits>
+#include <fstream>
+
+#include <canvas/gridmap.h>
+
+namespace cnv {
+
+// a number in a PBM header, after whitespace and # comments. Takes the whitespace after it too.
+static bool readNumber(std::istream& in, uint64_t& number)
+{
+	int c = in.get();
+	while (c == '#' || std::isspace(c)) {
+		if (c == '#') {
+			while (c != '\n' && c != EOF) { c = in.get(); }
+		}
+		c = in.get();
+	}
+	if (!std::isdigit(c)) {
+		return false;
+	}
+	number = 0;
+	while (std::isdigit(c)) {
+		number = number * 10 + (c - '0');
+		c = in.get();
+	}
+	return true;
+}
+
+GridMap::GridMap(int width, int height) :
+	_width(width),
+	_height(height),
+	_start(rt::vec2i(-1, -1)),
+	_end(rt::vec2i(-1, -1))
+{
+	_walls = std::vector<uint64_t>((size() + 63) / 64, 0);
+}
+
+GridMap::GridMap(rt::PixelBuffer& pixelbuffer) :
+	GridMap(pixelbuffer.width(), pixelbuffer.height())
+{
+	std::vector<rt::RGBAColor>& pixels = pixelbuffer.pixels();
+	for (size_t i = 0; i < pixels.size(); i++) {
+		const rt::RGBAColor& color = pixels[i];
+		if (color == BLACK) {
+			_walls[i / 64] |= (uint64_t)1 << (i % 64);
+		} else if (color == RED) {
+			_start = rt::vec2i(i % _width, i / _width);
+		} else if (color == BLUE) {
+			_end = rt::vec2i(i % _width, i / _width);
+		}
+	}
+}
+
+GridMap::~GridMap()
+{
+
+}
+
+bool GridMap::read(const std::string& filename)
+{
+	_width = 0;
+	_height = 0;
+	_walls.clear();
+	_start = rt::vec2i(-1, -1);
+	_end = rt::vec2i(-1, -1);
+
+	std::ifstream in(filename, std::ios::binary);
+	uint64_t width = 0;
+	uint64_t height = 0;
+	if (!in || in.get() != 'P' || in.get() != '4' || !readNumber(in, width) || !readNumber(in, height)) {
+		return false;
+	}
+	if (width == 0 || height == 0 || width > INT_MAX || height > INT_MAX) {
+		return false;
+	}
+	_width = width;
+	_height = height;
+	_walls = std::vector<uint64_t>((size() + 63) / 64, 0);
+
+	// a row at a time, 8 pixels per byte, the first one in the high bit
+	std::vector<unsigned char> row((width + 7) / 8);
+	size_t first = size();
+	size_t last = size();
+	for (uint64_t y = 0; y < height; y++) {
+		if (!in.read((char*)row.data(), row.size())) {
+			*this = GridMap(0, 0);
+			return false;
+		}
+		size_t i = y * width;
+		for (uint64_t x = 0; x < width; x++, i++) {
+			if ((row[x / 8] << (x % 8)) & 0x80) {
+				_walls[i / 64] |= (uint64_t)1 << (i % 64);
+			} else {
+				if (first == size()) { first = i; }
+				last = i;
+			}
+		}
+	}
+	if (first < size()) {
+		_start = rt::vec2i(first % _width, first / _width);
+		_end = rt::vec2i(last % _width, last / _width);
+	}
+	return true;
+}
+
+void GridMap::setWall(int x, int y, bool wall)
+{
+	if (x < 0 || y < 0 || x >= _width || y >= _height) {
+		return;
+	}
+	size_t i = index(x, y);
+	if (wall) {
+		_walls[i / 64] |= (uint64_t)1 << (i % 64);
+	} else {
+		_walls[i / 64] &= ~((uint64_t)1 << (i % 64));
+	}
+}
+
+} // namespace cnv
@@ -0,0 +1,70 @@
+/**
+ * @file gridmap.h
+ * @brief cnv::GridMap header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef GRIDMAP_H
+#define GRIDMAP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <pixelbuffer/pixelbuffer.h>
+
+namespace cnv {
+
+/// @brief The walls of a grid, a bit per cell. Outside of the grid is a wall.
+/// From a pixelbuffer (a maze, a cave): BLACK is a wall, any other color is open.
+/// A RED pixel is the start, a BLUE pixel the end.
+/// Or from a PBM file (P4, like the mazes of MazeStream that don't fit in a PBF): 1 is a wall.
+class GridMap
+{
+public:
+	/// @brief a grid without walls
+	GridMap(int width, int height);
+	/// @brief the walls of a pixelbuffer
+	GridMap(rt::PixelBuffer& pixelbuffer);
+	virtual ~GridMap();
+
+	/// @brief replace the grid with the walls of a PBM file (P4). It has no colors: the start is the
+	/// first open cell (row after row), the end the last one.
+	/// @param filename the file
+	/// @return false if it couldn't be read, the grid is empty then
+	bool read(const std::string& filename);
+
+	int width() const { return _width; }
+	int height() const { return _height; }
+	size_t size() const { return (size_t)_width * _height; }
+	size_t index(int x, int y) const { return (size_t)y * _width + x; }
+
+	bool wall(int x, int y) const
+	{
+		if (x < 0 || y < 0 || x >= _width || y >= _height) {
+			return true;
+		}
+		return wall(index(x, y));
+	}
+	bool wall(size_t index) const { return (_walls[index / 64] >> (index % 64)) & 1; }
+	void setWall(int x, int y, bool wall);
+
+	/// @brief the walls, 64 cells per word, row after row
+	const std::vector<uint64_t>& bits() const { return _walls; }
+
+	/// @brief the RED pixel (first open cell of a PBM), or -1, -1
+	rt::vec2i start() const { return _start; }
+	/// @brief the BLUE pixel (last open cell of a PBM), or -1, -1
+	rt::vec2i end() const { return _end; }
+
+private:
+	int _width;
+	int _height;
+	std::vector<uint64_t> _walls;
+	rt::vec2i _start;
+	rt::vec2i _end;
+};
+
+} // namespace cnv
+
+#endif /* GRIDMAP_H */
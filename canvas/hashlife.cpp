@@ -0,0 +1,463 @@
+/**
+ * @file hashlife.cpp
+ * @brief cnv::HashLife implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <cmath>
+
+#include <canvas/hashlife.h>
+
+namespace cnv {
+
+static const int MAXEXPONENT = 59; // the root (exponent + 3) must fit int64_t coordinates
+
+HashLife::HashLife(const LifeRule& rule) :
+	_rule(rule),
+	_generation(0),
+	_exponent(0),
+	_maxnodes(4 * 1024 * 1024),
+	_count(0)
+{
+	for (int i = 0; i < 2; i++) {
+		_cells[i].nw = _cells[i].ne = _cells[i].sw = _cells[i].se = nullptr;
+		_cells[i].result = nullptr;
+		_cells[i].population = i;
+		_cells[i].level = 0;
+		_cells[i].marked = true; // never collected
+	}
+	_empty.push_back(&_cells[0]);
+
+	rehash(1024);
+	_root = empty(3);
+}
+
+HashLife::~HashLife()
+{
+	for (Node* node : _table) {
+		delete node;
+	}
+}
+
+void HashLife::setRule(const LifeRule& rule)
+{
+	_rule = rule;
+	forget();
+}
+
+// nodes
+HashLife::Node* HashLife::join(Node* nw, Node* ne, Node* sw, Node* se)
+{
+	size_t h = (size_t)nw;
+	h = h * 0x9E3779B97F4A7C15ULL + (size_t)ne;
+	h = h * 0x9E3779B97F4A7C15ULL + (size_t)sw;
+	h = h * 0x9E3779B97F4A7C15ULL + (size_t)se;
+	h ^= h >> 29;
+
+	// already there?
+	size_t mask = _table.size() - 1;
+	size_t i = h & mask;
+	while (_table[i] != nullptr) {
+		Node* node = _table[i];
+		if (node->nw == nw && node->ne == ne && node->sw == sw && node->se == se) {
+			return node;
+		}
+		i = (i + 1) & mask;
+	}
+
+	Node* node = new Node();
+	node->nw = nw;
+	node->ne = ne;
+	node->sw = sw;
+	node->se = se;
+	node->result = nullptr;
+	node->population = nw->population + ne->population + sw->population + se->population;
+	node->level = nw->level + 1;
+	node->marked = false;
+
+	_table[i] = node;
+	_count++;
+	if (_count * 2 > _table.size()) {
+		rehash(_table.size() * 2);
+	}
+	return node;
+}
+
+void HashLife::insert(Node* node)
+{
+	size_t h = (size_t)node->nw;
+	h = h * 0x9E3779B97F4A7C15ULL + (size_t)node->ne;
+	h = h * 0x9E3779B97F4A7C15ULL + (size_t)node->sw;
+	h = h * 0x9E3779B97F4A7C15ULL + (size_t)node->se;
+	h ^= h >> 29;
+
+	size_t mask = _table.size() - 1;
+	size_t i = h & mask;
+	while (_table[i] != nullptr) {
+		i = (i + 1) & mask;
+	}
+	_table[i] = node;
+}
+
+void HashLife::rehash(size_t size)
+{
+	std::vector<Node*> old;
+	old.swap(_table);
+	_table = std::vector<Node*>(size, nullptr);
+	for (Node* node : old) {
+		if (node != nullptr) {
+			insert(node);
+		}
+	}
+}
+
+HashLife::Node* HashLife::empty(int level)
+{
+	while ((int)_empty.size() <= level) {
+		Node* e = _empty.back();
+		_empty.push_back(join(e, e, e, e));
+	}
+	return _empty[level];
+}
+
+HashLife::Node* HashLife::expand(Node* node)
+{
+	// same cells, twice the size around them
+	Node* e = empty(node->level - 1);
+	return join(
+		join(e, e, e, node->nw),
+		join(e, e, node->ne, e),
+		join(e, node->sw, e, e),
+		join(node->se, e, e, e)
+	);
+}
+
+HashLife::Node* HashLife::center(Node* node)
+{
+	return join(node->nw->se, node->ne->sw, node->sw->ne, node->se->nw);
+}
+
+HashLife::Node* HashLife::horizontal(Node* w, Node* e)
+{
+	return join(w->ne, e->nw, w->se, e->sw);
+}
+
+HashLife::Node* HashLife::vertical(Node* n, Node* s)
+{
+	return join(n->sw, n->se, s->nw, s->ne);
+}
+
+bool HashLife::centered(Node* node)
+{
+	// all cells in the center quarter (in width), so they can grow by a quarter on every side and still be in the result
+	uint64_t inside = node->nw->se->se->population + node->ne->sw->sw->population + node->sw->ne->ne->population + node->se->nw->nw->population;
+	return node->population == inside;
+}
+
+// stepping
+HashLife::Node* HashLife::base(Node* node)
+{
+	// 4x4 cells, the next generation of the center 2x2
+	int cells[4][4];
+	Node* quadrants[2][2] = { { node->nw, node->ne }, { node->sw, node->se } };
+	for (int qy = 0; qy < 2; qy++) {
+		for (int qx = 0; qx < 2; qx++) {
+			Node* q = quadrants[qy][qx];
+			cells[qy * 2 + 0][qx * 2 + 0] = q->nw->population;
+			cells[qy * 2 + 0][qx * 2 + 1] = q->ne->population;
+			cells[qy * 2 + 1][qx * 2 + 0] = q->sw->population;
+			cells[qy * 2 + 1][qx * 2 + 1] = q->se->population;
+		}
+	}
+
+	Node* next[2][2];
+	for (int y = 1; y < 3; y++) {
+		for (int x = 1; x < 3; x++) {
+			int n = 0;
+			for (int r = -1; r < 2; r++) {
+				for (int c = -1; c < 2; c++) {
+					n += cells[y + r][x + c];
+				}
+			}
+			n -= cells[y][x];
+			bool alive = cells[y][x] ? _rule.survive[n] : _rule.birth[n];
+			next[y - 1][x - 1] = &_cells[alive ? 1 : 0];
+		}
+	}
+	return join(next[0][0], next[0][1], next[1][0], next[1][1]);
+}
+
+HashLife::Node* HashLife::successor(Node* node)
+{
+	if (node->population == 0) {
+		return empty(node->level - 1);
+	}
+	if (node->result != nullptr) {
+		return node->result;
+	}
+
+	Node* result = nullptr;
+	int level = node->level;
+	if (level == 2) {
+		result = base(node);
+	} else {
+		// 9 overlapping nodes of half the size
+		Node* n00 = node->nw;
+		Node* n01 = horizontal(node->nw, node->ne);
+		Node* n02 = node->ne;
+		Node* n10 = vertical(node->nw, node->sw);
+		Node* n11 = center(node);
+		Node* n12 = vertical(node->ne, node->se);
+		Node* n20 = node->sw;
+		Node* n21 = horizontal(node->sw, node->se);
+		Node* n22 = node->se;
+
+		// full speed (2^(level-2)) takes two half steps, a smaller step only the second one
+		bool full = level - 2 <= _exponent;
+		Node* a00 = full ? successor(n00) : center(n00);
+		Node* a01 = full ? successor(n01) : center(n01);
+		Node* a02 = full ? successor(n02) : center(n02);
+		Node* a10 = full ? successor(n10) : center(n10);
+		Node* a11 = full ? successor(n11) : center(n11);
+		Node* a12 = full ? successor(n12) : center(n12);
+		Node* a20 = full ? successor(n20) : center(n20);
+		Node* a21 = full ? successor(n21) : center(n21);
+		Node* a22 = full ? successor(n22) : center(n22);
+
+		result = join(
+			successor(join(a00, a01, a10, a11)),
+			successor(join(a01, a02, a11, a12)),
+			successor(join(a10, a11, a20, a21)),
+			successor(join(a11, a12, a21, a22))
+		);
+	}
+
+	node->result = result;
+	return result;
+}
+
+void HashLife::stepPow2(int exponent)
+{
+	if (exponent < 0) { exponent = 0; }
+	if (exponent > MAXEXPONENT) { exponent = MAXEXPONENT; }
+	if (exponent != _exponent) {
+		_exponent = exponent;
+		forget();
+	}
+
+	// big enough to hold everything the pattern can become in 2^exponent generations
+	while (_root->level < exponent + 3 || !centered(_root)) {
+		_root = expand(_root);
+	}
+	_root = successor(_root);
+	_generation += 1ULL << exponent;
+
+	if (_count > _maxnodes) {
+		collect();
+	}
+}
+
+void HashLife::step(uint64_t generations)
+{
+	for (int i = 0; i <= MAXEXPONENT && generations > 0; i++) {
+		if (generations & 1) {
+			stepPow2(i);
+		}
+		generations >>= 1;
+	}
+}
+
+void HashLife::forget()
+{
+	for (Node* node : _table) {
+		if (node != nullptr) {
+			node->result = nullptr;
+		}
+	}
+}
+
+// garbage collection
+void HashLife::mark(Node* node)
+{
+	if (node->marked) {
+		return;
+	}
+	node->marked = true;
+	mark(node->nw);
+	mark(node->ne);
+	mark(node->sw);
+	mark(node->se);
+}
+
+void HashLife::collect()
+{
+	mark(_root);
+	for (Node* e : _empty) {
+		mark(e);
+	}
+
+	// keep what's marked, don't remember results we're throwing away
+	std::vector<Node*> keep;
+	for (Node* node : _table) {
+		if (node == nullptr) {
+			continue;
+		}
+		if (node->marked) {
+			if (node->result != nullptr && !node->result->marked) {
+				node->result = nullptr;
+			}
+			keep.push_back(node);
+		}
+	}
+	for (Node* node : _table) {
+		if (node != nullptr && !node->marked) {
+			delete node;
+		}
+	}
+
+	size_t size = 1024;
+	while (size < keep.size() * 2) {
+		size *= 2;
+	}
+	_table = std::vector<Node*>(size, nullptr);
+	for (Node* node : keep) {
+		node->marked = false;
+		insert(node);
+	}
+	_count = keep.size();
+}
+
+void HashLife::clear()
+{
+	_root = empty(3);
+	_generation = 0;
+	collect();
+}
+
+// cells
+uint8_t HashLife::getCell(int64_t x, int64_t y) const
+{
+	const Node* node = _root;
+	int64_t half = 1LL << (node->level - 1);
+	if (x < -half || x >= half || y < -half || y >= half) {
+		return 0;
+	}
+
+	while (node->level > 0) {
+		int64_t quarter = node->level >= 2 ? 1LL << (node->level - 2) : 0;
+		if (y < 0) {
+			node = x < 0 ? node->nw : node->ne;
+			y += quarter;
+		} else {
+			node = x < 0 ? node->sw : node->se;
+			y -= quarter;
+		}
+		x += x < 0 ? quarter : -quarter;
+	}
+	return node->population;
+}
+
+void HashLife::setCell(int64_t x, int64_t y, uint8_t state)
+{
+	while (true) {
+		int64_t half = 1LL << (_root->level - 1);
+		if (x >= -half && x < half && y >= -half && y < half) {
+			break;
+		}
+		_root = expand(_root);
+	}
+	_root = setCell(_root, x, y, state);
+}
+
+HashLife::Node* HashLife::setCell(Node* node, int64_t x, int64_t y, uint8_t state)
+{
+	if (node->level == 0) {
+		return &_cells[state ? 1 : 0];
+	}
+
+	// coordinates relative to the center of the quadrant
+	int64_t quarter = node->level >= 2 ? 1LL << (node->level - 2) : 0;
+	int64_t qx = x < 0 ? x + quarter : x - quarter;
+	int64_t qy = y < 0 ? y + quarter : y - quarter;
+	if (y < 0) {
+		if (x < 0) {
+			return join(setCell(node->nw, qx, qy, state), node->ne, node->sw, node->se);
+		}
+		return join(node->nw, setCell(node->ne, qx, qy, state), node->sw, node->se);
+	}
+	if (x < 0) {
+		return join(node->nw, node->ne, setCell(node->sw, qx, qy, state), node->se);
+	}
+	return join(node->nw, node->ne, node->sw, setCell(node->se, qx, qy, state));
+}
+
+// rendering
+void HashLife::render(rt::PixelBuffer& pixelbuffer, int64_t left, int64_t top, int zoom, const rt::RGBAColor& alive, const rt::RGBAColor& dead) const
+{
+	int cols = pixelbuffer.width();
+	int rows = pixelbuffer.height();
+	if (zoom < 0) { zoom = 0; }
+	if (zoom > 46) { zoom = 46; } // keep the window in int64_t
+
+	// whole pixels
+	int64_t pixel = 1LL << zoom;
+	left = left >= 0 ? left / pixel * pixel : -((-left + pixel - 1) / pixel) * pixel;
+	top = top >= 0 ? top / pixel * pixel : -((-top + pixel - 1) / pixel) * pixel;
+
+	// living cells per pixel
+	std::vector<uint64_t> counts(cols * rows, 0);
+	int64_t half = 1LL << (_root->level - 1);
+	accumulate(_root, -half, -half, left, top, zoom, cols, rows, counts);
+
+	double area = (double)pixel * (double)pixel;
+	std::vector<rt::RGBAColor>& pixels = pixelbuffer.pixels();
+	for (size_t i = 0; i < counts.size(); i++) {
+		if (counts[i] == 0) {
+			pixels[i] = dead;
+			continue;
+		}
+		// a few cells in a big pixel should still show up
+		float t = 0.25f + 0.75f * std::sqrt(counts[i] / area);
+		rt::RGBAColor color;
+		color.r = dead.r + (alive.r - dead.r) * t;
+		color.g = dead.g + (alive.g - dead.g) * t;
+		color.b = dead.b + (alive.b - dead.b) * t;
+		color.a = dead.a + (alive.a - dead.a) * t;
+		pixels[i] = color;
+	}
+}
+
+void HashLife::accumulate(const Node* node, int64_t x, int64_t y, int64_t left, int64_t top, int zoom, int cols, int rows, std::vector<uint64_t>& counts) const
+{
+	if (node->population == 0) {
+		return;
+	}
+
+	// outside the window?
+	int64_t size = 1LL << node->level;
+	int64_t pixel = 1LL << zoom;
+	int64_t right = left + cols * pixel;
+	int64_t bottom = top + rows * pixel;
+	if (x >= right || y >= bottom || x + size <= left || y + size <= top) {
+		return;
+	}
+
+	// fits in one pixel: its first and last cell are in the same one. Not just any node that isn't bigger than
+	// a pixel, the root is centered on 0,0 so it doesn't line up with them.
+	int64_t px = (x - left) >> zoom;
+	int64_t py = (y - top) >> zoom;
+	if (px == (x + size - 1 - left) >> zoom && py == (y + size - 1 - top) >> zoom) {
+		if (px >= 0 && py >= 0 && px < cols && py < rows) {
+			counts[py * cols + px] += node->population;
+		}
+		return;
+	}
+
+	int64_t half = size / 2;
+	accumulate(node->nw, x, y, left, top, zoom, cols, rows, counts);
+	accumulate(node->ne, x + half, y, left, top, zoom, cols, rows, counts);
+	accumulate(node->sw, x, y + half, left, top, zoom, cols, rows, counts);
+	accumulate(node->se, x + half, y + half, left, top, zoom, cols, rows, counts);
+}
+
+} // namespace cnv
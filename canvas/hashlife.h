@@ -0,0 +1,123 @@
+/**
+ * @file hashlife.h
+ * @brief cnv::HashLife header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef HASHLIFE_H
+#define HASHLIFE_H
+
+#include <cstdint>
+#include <vector>
+
+#include <pixelbuffer/pixelbuffer.h>
+
+#include <canvas/life.h>
+
+namespace cnv {
+
+/// @brief Runs a 2 state life-like rule on an unbounded plane with Gosper's HashLife.
+/// The universe is a quadtree of canonical (shared) nodes, and the future of every node is remembered.
+/// Patterns that repeat themselves in space or time advance 2^k generations in about the time of one.
+/// Rules with B0 don't work on an unbounded plane, and Generations states are ignored.
+class HashLife
+{
+public:
+	/// @brief an empty universe
+	/// @param rule the rule
+	HashLife(const LifeRule& rule = LifeRule());
+	virtual ~HashLife();
+
+	/// @brief number of generations since construction (or clear())
+	uint64_t generation() const { return _generation; }
+	/// @brief number of cells alive
+	uint64_t population() const { return _root->population; }
+	/// @brief number of nodes in memory
+	size_t nodes() const { return _count; }
+
+	const LifeRule& rule() const { return _rule; }
+	/// @brief change the rule, forgets all results
+	void setRule(const LifeRule& rule);
+
+	/// @brief how many nodes there may be after a step, before unused nodes are thrown away
+	/// @param nodes maximum number of nodes (a node is about 64 bytes)
+	void setMaxNodes(size_t nodes) { _maxnodes = nodes; }
+
+	/// @brief state of a cell (0 or 1), (0,0) is the center of the universe
+	uint8_t getCell(int64_t x, int64_t y) const;
+	/// @brief set a cell alive (1) or dead (0)
+	void setCell(int64_t x, int64_t y, uint8_t state);
+
+	/// @brief everything dead, generation 0
+	void clear();
+
+	/// @brief advance 2^exponent generations.
+	/// Results are remembered per exponent, so keep using the same one.
+	/// @param exponent 0 .. 59
+	void stepPow2(int exponent);
+	/// @brief advance, in steps of powers of 2
+	/// @param generations number of generations
+	void step(uint64_t generations = 1);
+
+	/// @brief throw away all nodes that aren't part of the universe now
+	void collect();
+
+	/// @brief write a window of the universe into a pixelbuffer, the size of the pixelbuffer
+	/// @param pixelbuffer the pixelbuffer
+	/// @param left left of the window, in cells (rounded down to a multiple of 2^zoom)
+	/// @param top top of the window, in cells (rounded down to a multiple of 2^zoom)
+	/// @param zoom every pixel shows 2^zoom x 2^zoom cells, brighter when more of them are alive
+	/// @param alive color of living cells
+	/// @param dead color of dead cells
+	void render(rt::PixelBuffer& pixelbuffer, int64_t left, int64_t top, int zoom, const rt::RGBAColor& alive, const rt::RGBAColor& dead) const;
+
+private:
+	struct Node
+	{
+		Node* nw;
+		Node* ne;
+		Node* sw;
+		Node* se;
+		Node* result; // the center, 2^min(level-2, _exponent) generations later
+		uint64_t population;
+		int level; // 2^level x 2^level cells
+		bool marked;
+	};
+
+	LifeRule _rule;
+	uint64_t _generation;
+	int _exponent; // step the results are for
+	size_t _maxnodes;
+
+	// the universe, centered on (0,0)
+	Node* _root;
+
+	// the 2 cells, and empty nodes of every level
+	Node _cells[2];
+	std::vector<Node*> _empty;
+
+	// canonical nodes: open addressing, linear probing
+	std::vector<Node*> _table;
+	size_t _count;
+
+	Node* join(Node* nw, Node* ne, Node* sw, Node* se);
+	Node* empty(int level);
+	Node* expand(Node* node);
+	Node* center(Node* node);
+	Node* horizontal(Node* w, Node* e);
+	Node* vertical(Node* n, Node* s);
+	Node* successor(Node* node);
+	Node* base(Node* node);
+	bool centered(Node* node);
+	Node* setCell(Node* node, int64_t x, int64_t y, uint8_t state);
+
+	void insert(Node* node);
+	void rehash(size_t size);
+	void forget();
+	void mark(Node* node);
+	void accumulate(const Node* node, int64_t x, int64_t y, int64_t left, int64_t top, int zoom, int cols, int rows, std::vector<uint64_t>& counts) const;
+};
+
+} // namespace cnv
+
+#endif /* HASHLIFE_H */
@@ -20,9 +20,12 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
 Input::Input(GLFWwindow* win) : _window(win)
 {
 	_gscroll = 0;
+	_scroll = 0;
 
 	_windowWidth = 0;
 	_windowHeight = 0;
+	_mouseX = 0;
+	_mouseY = 0;
 
 	for(unsigned int i=0; i<GLFW_KEY_LAST; i++) {
 		_keys[i] = false;
@@ -35,7 +38,9 @@ Input::Input(GLFWwindow* win) : _window(win)
 		_mouseDown[i] = false;
 	}
 
-	glfwSetScrollCallback(_window, scroll_callback);
+	if (_window) {
+		glfwSetScrollCallback(_window, scroll_callback);
+	}
 }
 
 Input::~Input()
@@ -48,7 +53,12 @@ void Input::updateInput(uint16_t width, uint16_t height)
 	// _window = win;
 
 	_gscroll = 0; // reset scrollwheel
+	_scroll = 0;
+	if (!_window) {
+		return; // headless
+	}
 	glfwPollEvents();
+	_scroll = _gscroll;
 
 	// 32-97 = ' ' to '`'
 	for(unsigned int i=32; i<97; i++) {
@@ -73,6 +83,40 @@ void Input::updateInput(uint16_t width, uint16_t height)
 	}
 }
 
+void Input::clearEvents()
+{
+	_scroll = 0;
+	for(unsigned int i=0; i<GLFW_KEY_LAST; i++) {
+		_keysUp[i] = false;
+		_keysDown[i] = false;
+	}
+	for(unsigned int i=0; i<GLFW_MOUSE_BUTTON_LAST; i++) {
+		_mouseUp[i] = false;
+		_mouseDown[i] = false;
+	}
+}
+
+void Input::accumulate(const Input& newer)
+{
+	for(unsigned int i=0; i<GLFW_KEY_LAST; i++) {
+		_keys[i] = newer._keys[i];
+		_keysUp[i] = _keysUp[i] || newer._keysUp[i];
+		_keysDown[i] = _keysDown[i] || newer._keysDown[i];
+	}
+	for(unsigned int i=0; i<GLFW_MOUSE_BUTTON_LAST; i++) {
+		_mouse[i] = newer._mouse[i];
+		_mouseUp[i] = _mouseUp[i] || newer._mouseUp[i];
+		_mouseDown[i] = _mouseDown[i] || newer._mouseDown[i];
+	}
+	_mouseX = newer._mouseX;
+	_mouseY = newer._mouseY;
+	_windowWidth = newer._windowWidth;
+	_windowHeight = newer._windowHeight;
+	if (_scroll == 0) {
+		_scroll = newer._scroll;
+	}
+}
+
 void Input::_handleMouse(unsigned int button)
 {
 	if (glfwGetMouseButton( _window, button ) == GLFW_PRESS) {
@@ -100,7 +144,7 @@ void Input::_handleMouse(unsigned int button)
 }
 
 int Input::getScrollY() {
-	return _gscroll;
+	return _scroll;
 }
 
 void Input::_handleKey(unsigned int key)
@@ -156,13 +156,19 @@ enum class KeyCode : uint16_t
 class Input
 {
 public:
-	Input(GLFWwindow* win); ///< @brief Constructor of the Input
+	Input(GLFWwindow* win); ///< @brief Constructor of the Input (without a window, nothing is ever pressed)
 	virtual ~Input(); ///< @brief Destructor of the Input
 
 	/// @brief updates the input from Keyboard and Mouse.
 	/// @param[in] width cols of pixelbuffer
 	/// @param[in] height cols of pixelbuffer
 	void updateInput(uint16_t width, uint16_t height);
+	/// @brief forget keys and buttons that went down or up, and the scrollwheel.
+	/// Keys and buttons that are held stay pressed.
+	void clearEvents();
+	/// @brief take over the state of a newer Input, keeping the events we have that weren't seen yet.
+	/// @param[in] newer Input that was updated more recently
+	void accumulate(const Input& newer);
 
 	// keys while down
 	/// @brief Is this key pressed?
@@ -229,13 +235,13 @@ public:
 	/// @return _mouseY as double
 	double getMouseY() { return _mouseY; }
 	/// @brief get vertical scrollwheel
-	/// @return _gscroll as int (0 is untouched, -1 is up, 1 is down)
+	/// @return _scroll as int (0 is untouched, -1 is up, 1 is down)
 	int getScrollY();
 	/// @brief Set Mouse cursor to a certain position
 	/// @param[in] x The X position
 	/// @param[in] y The Y position
 	/// @return void
-	void setMouse(double x, double y) { glfwSetCursorPos(_window, x, y); };
+	void setMouse(double x, double y) { if (_window) { glfwSetCursorPos(_window, x, y); } };
 
 	// window size
 	/// @brief get width of the window
@@ -261,6 +267,8 @@ private:
 	double _mouseX; ///< @brief X position of the Mouse
 	double _mouseY; ///< @brief Y position of the Mouse
 
+	int _scroll; ///< @brief vertical scrollwheel since the last updateInput()
+
 	int _windowWidth; ///< @brief Width of the window
 	int _windowHeight; ///< @brief Height of the window
 };
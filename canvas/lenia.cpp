@@ -0,0 +1,147 @@
+/**
+ * @file lenia.cpp
+ * @brief cnv::LeniaEngine implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <canvas/lenia.h>
+#include <canvas/parallel.h>
+
+namespace cnv {
+
+LeniaEngine::LeniaEngine(int width, int height, int radius) :
+	_width(width),
+	_height(height),
+	_fft(width, height)
+{
+	_field = std::vector<float>(width * height, 0.0f);
+	_potential = std::vector<float>(width * height, 0.0f);
+	_spectrum = std::vector<std::complex<float>>(_fft.spectrumSize());
+	_kernel = std::vector<std::complex<float>>(_fft.spectrumSize());
+	setRadius(radius);
+}
+
+LeniaEngine::~LeniaEngine()
+{
+
+}
+
+void LeniaEngine::setRadius(int radius)
+{
+	_radius = std::max(1, radius);
+
+	// the kernel around cell (0,0), wrapped around the edges
+	std::vector<float> kernel(_width * _height, 0.0f);
+	float total = 0.0f;
+	for (int dy = -_radius; dy <= _radius; dy++) {
+		for (int dx = -_radius; dx <= _radius; dx++) {
+			float r = std::sqrt((float)(dx * dx + dy * dy)) / _radius;
+			if (r <= 0.0f || r >= 1.0f) {
+				continue;
+			}
+			float weight = std::exp(4.0f - 1.0f / (r * (1.0f - r)));
+			rt::vec2i p = rt::wrap(rt::vec2i(dx, dy), _width, _height);
+			kernel[rt::index(p.x, p.y, _width)] += weight;
+			total += weight;
+		}
+	}
+	if (total > 0.0f) {
+		for (size_t i = 0; i < kernel.size(); i++) {
+			kernel[i] /= total;
+		}
+	}
+
+	// only once, not every step
+	_fft.forward(kernel.data(), _kernel.data());
+}
+
+float LeniaEngine::get(int x, int y) const
+{
+	rt::vec2i p = rt::wrap(rt::vec2i(x, y), _width, _height);
+	return _field[rt::index(p.x, p.y, _width)];
+}
+
+void LeniaEngine::set(int x, int y, float value)
+{
+	rt::vec2i p = rt::wrap(rt::vec2i(x, y), _width, _height);
+	_field[rt::index(p.x, p.y, _width)] = value;
+}
+
+void LeniaEngine::clear()
+{
+	std::fill(_field.begin(), _field.end(), 0.0f);
+}
+
+void LeniaEngine::randomize(unsigned int seed)
+{
+	clear();
+
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> value(0.0f, 1.0f);
+	int size = _radius * 2;
+	int patches = (_width * _height) / (size * size * 8) + 1;
+	for (int i = 0; i < patches; i++) {
+		int left = rng() % _width;
+		int top = rng() % _height;
+		for (int y = 0; y < size; y++) {
+			for (int x = 0; x < size; x++) {
+				set(left + x, top + y, value(rng));
+			}
+		}
+	}
+}
+
+void LeniaEngine::step(float dt, const std::function<void(float* values, size_t count)>& growth, const std::function<void(float* values, size_t count)>& normalize)
+{
+	// convolve: multiply the spectra
+	_fft.forward(_field.data(), _spectrum.data());
+	parallel_for(_spectrum.size(), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			_spectrum[i] *= _kernel[i];
+		}
+	});
+	_fft.inverse(_spectrum.data(), _potential.data());
+
+	parallel_for_rows(_height, [&](const RowBand& band) {
+		for (size_t y = band.begin; y < band.end; y++) {
+			float* potential = &_potential[y * _width];
+			float* row = &_field[y * _width];
+			if (growth) {
+				growth(potential, _width);
+			}
+			for (int x = 0; x < _width; x++) {
+				row[x] += dt * potential[x];
+			}
+			if (normalize) {
+				normalize(row, _width);
+			}
+		}
+	}, _width * sizeof(float) * 2);
+}
+
+void LeniaEngine::render(rt::PixelBuffer& pixelbuffer) const
+{
+	if (pixelbuffer.width() != _width || pixelbuffer.height() != _height) {
+		return;
+	}
+
+	std::vector<rt::RGBAColor>& pixels = pixelbuffer.pixels();
+	parallel_for_rows(_height, [&](const RowBand& band) {
+		for (size_t y = band.begin; y < band.end; y++) {
+			const float* row = &_field[y * _width];
+			rt::RGBAColor* out = &pixels[y * _width];
+			for (int x = 0; x < _width; x++) {
+				// map from 0-1 to 0-255
+				float value = std::min(1.0f, std::max(0.0f, row[x]));
+				uint8_t gray = value * 255;
+				out[x] = rt::RGBAColor(gray, gray, gray, 255);
+			}
+		}
+	});
+}
+
+} // namespace cnv
@@ -0,0 +1,74 @@
+/**
+ * @file lenia.h
+ * @brief cnv::LeniaEngine header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef LENIA_H
+#define LENIA_H
+
+#include <complex>
+#include <functional>
+#include <vector>
+
+#include <pixelbuffer/pixelbuffer.h>
+
+#include <canvas/fft.h>
+
+namespace cnv {
+
+/// @brief A continuous cellular automaton (Lenia) on a toroidal field of floats.
+/// The field is convolved with a ring kernel of any radius in the frequency domain: one FFT of
+/// the field, a multiplication with the (cached) spectrum of the kernel, and one inverse FFT.
+/// That costs the same for a radius of 5 or 50.
+class LeniaEngine
+{
+public:
+	/// @brief a field of zeros, and a ring kernel
+	/// @param width width
+	/// @param height height
+	/// @param radius radius of the kernel
+	LeniaEngine(int width, int height, int radius = 13);
+	virtual ~LeniaEngine();
+
+	int width() const { return _width; }
+	int height() const { return _height; }
+	int radius() const { return _radius; }
+
+	/// @brief a ring kernel: exp(4 - 1/(r*(1-r))) for r = distance/radius, weights sum up to 1
+	/// @param radius radius of the kernel
+	void setRadius(int radius);
+
+	/// @brief value of a cell, wraps around
+	float get(int x, int y) const;
+	/// @brief set the value of a cell, wraps around
+	void set(int x, int y, float value);
+	/// @brief all zeros
+	void clear();
+	/// @brief random values in square patches (2*radius wide) here and there
+	void randomize(unsigned int seed);
+
+	/// @brief value += dt * growth(field convolved with the kernel), then normalize
+	/// @param dt time step
+	/// @param growth called with a row of convolved values at a time, to change in place
+	/// @param normalize called with a row of new values at a time, to change in place. Can be empty.
+	void step(float dt, const std::function<void(float* values, size_t count)>& growth, const std::function<void(float* values, size_t count)>& normalize);
+
+	/// @brief write the field into a pixelbuffer of the same size, 0 .. 1 as black .. white
+	void render(rt::PixelBuffer& pixelbuffer) const;
+
+private:
+	int _width;
+	int _height;
+	int _radius;
+
+	RealFFT2D _fft;
+	std::vector<std::complex<float>> _kernel; // spectrum of the kernel
+	std::vector<std::complex<float>> _spectrum;
+	std::vector<float> _field;
+	std::vector<float> _potential; // field convolved with the kernel
+};
+
+} // namespace cnv
+
+#endif /* LENIA_H */
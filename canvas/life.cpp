@@ -0,0 +1,252 @@
+/**
+ * @file life.cpp
+ * @brief cnv::LifeRule, cnv::LifeEngine implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <cctype>
+#include <random>
+
+#include <canvas/life.h>
+
+namespace cnv {
+
+// LifeRule
+LifeRule::LifeRule()
+{
+	parse("B3/S23");
+}
+
+LifeRule::LifeRule(const std::string& rule)
+{
+	parse(rule);
+}
+
+LifeRule::~LifeRule()
+{
+
+}
+
+bool LifeRule::parse(const std::string& rule)
+{
+	for (int i = 0; i < 9; i++) {
+		birth[i] = false;
+		survive[i] = false;
+	}
+	states = 2;
+	_valid = false;
+
+	// split on '/'
+	std::vector<std::string> parts(1);
+	for (char c : rule) {
+		if (c == '/') {
+			parts.push_back("");
+		} else if (!isspace((unsigned char)c)) {
+			parts.back() += c;
+		}
+	}
+	if (parts.size() < 2 || parts.size() > 3) {
+		return false;
+	}
+
+	// "B3/S23/C3" (any order) or "23/3/3" (survive/birth/states)
+	bool bfound = false;
+	bool sfound = false;
+	for (size_t i = 0; i < parts.size(); i++) {
+		std::string part = parts[i];
+		char kind = 0;
+		if (!part.empty() && isalpha((unsigned char)part[0])) {
+			kind = toupper((unsigned char)part[0]);
+			part = part.substr(1);
+		} else {
+			kind = "SBC"[i];
+		}
+
+		if (kind == 'C' || kind == 'G') {
+			if (part.empty() || part.size() > 3) { return false; }
+			int n = 0;
+			for (char c : part) {
+				if (!isdigit((unsigned char)c)) { return false; }
+				n = n * 10 + (c - '0');
+			}
+			if (n < 2 || n > 256) { return false; }
+			states = n;
+			continue;
+		}
+
+		bool* counts = nullptr;
+		if (kind == 'B' && !bfound) { counts = birth; bfound = true; }
+		if (kind == 'S' && !sfound) { counts = survive; sfound = true; }
+		if (counts == nullptr) { return false; }
+		for (char c : part) {
+			if (c < '0' || c > '8') { return false; }
+			counts[c - '0'] = true;
+		}
+	}
+
+	_valid = bfound && sfound;
+	return _valid;
+}
+
+std::string LifeRule::str() const
+{
+	std::string rule = "B";
+	for (int i = 0; i < 9; i++) {
+		if (birth[i]) { rule += (char)('0' + i); }
+	}
+	rule += "/S";
+	for (int i = 0; i < 9; i++) {
+		if (survive[i]) { rule += (char)('0' + i); }
+	}
+	if (states > 2) {
+		rule += "/C" + std::to_string(states);
+	}
+	return rule;
+}
+
+// LifeEngine
+LifeEngine::LifeEngine(int width, int height, const LifeRule& rule) :
+	_width(width),
+	_height(height),
+	_rule(rule),
+	_generation(0),
+	_current(0)
+{
+	_cells[0] = std::vector<uint8_t>(width * height, 0);
+	_cells[1] = std::vector<uint8_t>(width * height, 0);
+	compile();
+}
+
+LifeEngine::~LifeEngine()
+{
+
+}
+
+void LifeEngine::setRule(const LifeRule& rule)
+{
+	_rule = rule;
+	for (auto& cell : _cells[_current]) {
+		if (cell >= _rule.states) { cell = 0; }
+	}
+	compile();
+}
+
+void LifeEngine::compile()
+{
+	int states = _rule.states;
+	_table = std::vector<uint8_t>(states * 9, 0);
+	for (int n = 0; n < 9; n++) {
+		// dead
+		_table[0 * 9 + n] = _rule.birth[n] ? 1 : 0;
+		// alive: survive, or start dying (just dead for 2 states)
+		_table[1 * 9 + n] = _rule.survive[n] ? 1 : (states > 2 ? 2 : 0);
+		// dying: one state further, whatever the neighbours
+		for (int s = 2; s < states; s++) {
+			_table[s * 9 + n] = (s + 1) % states;
+		}
+	}
+}
+
+uint8_t LifeEngine::getCell(int x, int y) const
+{
+	rt::vec2i p = rt::wrap(rt::vec2i(x, y), _width, _height);
+	return _cells[_current][rt::index(p.x, p.y, _width)];
+}
+
+void LifeEngine::setCell(int x, int y, uint8_t state)
+{
+	rt::vec2i p = rt::wrap(rt::vec2i(x, y), _width, _height);
+	_cells[_current][rt::index(p.x, p.y, _width)] = state < _rule.states ? state : 1;
+}
+
+void LifeEngine::clear()
+{
+	std::fill(_cells[_current].begin(), _cells[_current].end(), 0);
+	_generation = 0;
+}
+
+void LifeEngine::randomize(int percentage, unsigned int seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int> dist(0, 99);
+	for (auto& cell : _cells[_current]) {
+		cell = dist(rng) < percentage ? 1 : 0;
+	}
+}
+
+void LifeEngine::step(int generations)
+{
+	size_t rowbytes = _width * 3;
+	for (int i = 0; i < generations; i++) {
+		parallel_for_rows(_height, [this](const RowBand& band) {
+			stepRows(band);
+		}, rowbytes);
+		_current ^= 1;
+		_generation++;
+	}
+}
+
+void LifeEngine::stepRows(const RowBand& band)
+{
+	const uint8_t* src = _cells[_current].data();
+	uint8_t* dst = _cells[_current ^ 1].data();
+	const uint8_t* table = _table.data();
+	size_t cols = _width;
+
+	// alive cells per column over the 3 rows, reused between generations
+	static thread_local std::vector<uint8_t> sums;
+	sums.resize(cols);
+
+	for (size_t y = band.begin; y < band.end; y++) {
+		const uint8_t* above = src + band.above(y) * cols;
+		const uint8_t* row = src + y * cols;
+		const uint8_t* below = src + band.below(y) * cols;
+		uint8_t* out = dst + y * cols;
+
+		for (size_t x = 0; x < cols; x++) {
+			sums[x] = (above[x] == 1) + (row[x] == 1) + (below[x] == 1);
+		}
+
+		// slide a window of 3 columns along the row (wrapped at both ends)
+		int window = sums[cols - 1] + sums[0] + sums[1 % cols];
+		for (size_t x = 0; x < cols; x++) {
+			uint8_t state = row[x];
+			int neighbours = window - (state == 1);
+			out[x] = table[state * 9 + neighbours];
+
+			size_t leaving = x == 0 ? cols - 1 : x - 1;
+			size_t entering = (x + 2) % cols;
+			window += sums[entering] - sums[leaving];
+		}
+	}
+}
+
+void LifeEngine::render(rt::PixelBuffer& pixelbuffer, const rt::RGBAColor& alive, const rt::RGBAColor& dead) const
+{
+	if (pixelbuffer.width() != _width || pixelbuffer.height() != _height) {
+		return;
+	}
+
+	// a color for every state
+	int states = _rule.states;
+	std::vector<rt::RGBAColor> palette(states);
+	palette[0] = dead;
+	for (int s = 1; s < states; s++) {
+		// 1 is alive, then fade to dead
+		float t = states > 2 ? (float)(s - 1) / (states - 1) : 0.0f;
+		palette[s].r = alive.r + (dead.r - alive.r) * t;
+		palette[s].g = alive.g + (dead.g - alive.g) * t;
+		palette[s].b = alive.b + (dead.b - alive.b) * t;
+		palette[s].a = alive.a + (dead.a - alive.a) * t;
+	}
+
+	const uint8_t* cells = _cells[_current].data();
+	std::vector<rt::RGBAColor>& pixels = pixelbuffer.pixels();
+	parallel_for(pixels.size(), [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			pixels[i] = palette[cells[i]];
+		}
+	});
+}
+
+} // namespace cnv
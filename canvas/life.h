@@ -0,0 +1,111 @@
+/**
+ * @file life.h
+ * @brief cnv::LifeRule, cnv::LifeEngine header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef LIFE_H
+#define LIFE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <pixelbuffer/pixelbuffer.h>
+
+#include <canvas/parallel.h>
+
+namespace cnv {
+
+/// @brief A life-like rule: which neighbour counts give birth, which keep a cell alive.
+/// Written as "B3/S23", "S23/B3" or "23/3" (survive/birth).
+/// Generations rules add a number of states: "B2/S/C3" or "/2/3". Cells that don't survive
+/// go through the dying states 2 .. C-1 before they're dead, and only state 1 counts as a neighbour.
+class LifeRule
+{
+public:
+	/// @brief Conway's Game of Life, B3/S23
+	LifeRule();
+	/// @brief parse a rule string, check valid() afterwards
+	/// @param rule "B3/S23", "B5678/S345678", "B2/S/C3", "23/3", ...
+	LifeRule(const std::string& rule);
+	virtual ~LifeRule();
+
+	/// @brief false if the string couldn't be parsed
+	bool valid() const { return _valid; }
+	/// @brief the rule as "B3/S23" (or "B2/S/C3" for more than 2 states)
+	std::string str() const;
+
+	bool birth[9];
+	bool survive[9];
+	int states; ///< @brief 2 for life-like rules, up to 256 for Generations
+
+private:
+	bool _valid;
+	bool parse(const std::string& rule);
+};
+
+/// @brief Runs a life-like (or Generations) cellular automaton on a toroidal grid.
+/// The rule is compiled into a table of next states, the neighbours are counted with a
+/// sliding sum over column sums, and row bands run on the ThreadPool.
+class LifeEngine
+{
+public:
+	/// @brief an empty (dead) world
+	/// @param width width
+	/// @param height height
+	/// @param rule the rule
+	LifeEngine(int width, int height, const LifeRule& rule = LifeRule());
+	virtual ~LifeEngine();
+
+	int width() const { return _width; }
+	int height() const { return _height; }
+	/// @brief number of steps since construction (or clear())
+	uint64_t generation() const { return _generation; }
+
+	const LifeRule& rule() const { return _rule; }
+	/// @brief change the rule, cells keep their state (above the new number of states become dead)
+	void setRule(const LifeRule& rule);
+
+	/// @brief state of a cell, wraps around
+	uint8_t getCell(int x, int y) const;
+	/// @brief set the state of a cell, wraps around
+	void setCell(int x, int y, uint8_t state);
+	/// @brief the states of all cells, row by row
+	std::vector<uint8_t>& cells() { return _cells[_current]; }
+
+	/// @brief everything dead, generation 0
+	void clear();
+	/// @brief every cell alive with a chance of percentage
+	void randomize(int percentage, unsigned int seed);
+
+	/// @brief advance
+	/// @param generations number of generations
+	void step(int generations = 1);
+
+	/// @brief write the cells into a pixelbuffer of the same size
+	/// @param pixelbuffer the pixelbuffer
+	/// @param alive color of state 1
+	/// @param dead color of state 0, dying states fade from alive to dead
+	void render(rt::PixelBuffer& pixelbuffer, const rt::RGBAColor& alive, const rt::RGBAColor& dead) const;
+
+private:
+	int _width;
+	int _height;
+	LifeRule _rule;
+	uint64_t _generation;
+
+	// double buffered, _cells[_current] is now
+	std::vector<uint8_t> _cells[2];
+	int _current;
+
+	// next state = _table[state * 9 + alive neighbours]
+	std::vector<uint8_t> _table;
+
+	void compile();
+	void stepRows(const RowBand& band);
+};
+
+} // namespace cnv
+
+#endif /* LIFE_H */
@@ -0,0 +1,363 @@
+/**
+ * @file mazegenerator.cpp
+ * @brief cnv::MazeGenerator, cnv::EllerGenerator implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <algorithm>
+
+#include <canvas/mazegenerator.h>
+
+namespace cnv {
+
+static const uint32_t NONE = 0xFFFFFFFF;
+
+// ###############################################
+// EllerGenerator
+// ###############################################
+
+EllerGenerator::EllerGenerator(int cols, unsigned int seed) :
+	_cols(cols),
+	_rng(seed),
+	_coins(0),
+	_coinsleft(0)
+{
+	_set = std::vector<uint32_t>(cols, 0);
+	_parent = std::vector<uint32_t>(cols, 0);
+	_count = std::vector<uint32_t>(cols, 0);
+	_chosen = std::vector<uint32_t>(cols, 0);
+	_label = std::vector<uint32_t>(cols, NONE);
+	_down = std::vector<uint8_t>(cols, 0);
+	_right = std::vector<uint8_t>(cols, 1);
+	_bottom = std::vector<uint8_t>(cols, 1);
+	reset();
+}
+
+EllerGenerator::~EllerGenerator()
+{
+
+}
+
+void EllerGenerator::reset()
+{
+	for (int x = 0; x < _cols; x++) {
+		_set[x] = x;
+	}
+}
+
+uint32_t EllerGenerator::find(uint32_t a)
+{
+	while (_parent[a] != a) {
+		_parent[a] = _parent[_parent[a]];
+		a = _parent[a];
+	}
+	return a;
+}
+
+void EllerGenerator::next(bool last)
+{
+	// sets are numbered 0 .. cols-1 in every row
+	for (int i = 0; i < _cols; i++) {
+		_parent[i] = i;
+	}
+
+	// join neighbours of different sets, at random (all of them in the last row)
+	for (int x = 0; x < _cols; x++) {
+		_right[x] = 1;
+		_bottom[x] = 1;
+	}
+	for (int x = 0; x + 1 < _cols; x++) {
+		uint32_t a = find(_set[x]);
+		uint32_t b = find(_set[x + 1]);
+		if (a != b && (last || coin())) {
+			_right[x] = 0;
+			_parent[a] = b;
+		}
+	}
+	if (last) {
+		return;
+	}
+
+	// go down at random...
+	for (int x = 0; x < _cols; x++) {
+		uint32_t set = find(_set[x]);
+		_set[x] = set;
+		if (coin()) {
+			_bottom[x] = 0;
+			_down[set] = 1;
+		}
+	}
+	// ...and a random cell of every set that didn't (reservoir sampling)
+	for (int x = 0; x < _cols; x++) {
+		uint32_t set = _set[x];
+		if (!_down[set]) {
+			_count[set]++;
+			if (_count[set] == 1 || _rng() % _count[set] == 0) {
+				_chosen[set] = x;
+			}
+		}
+	}
+	for (int x = 0; x < _cols; x++) {
+		uint32_t set = _set[x];
+		if (!_down[set] && _chosen[set] == (uint32_t)x) {
+			_bottom[x] = 0;
+		}
+	}
+
+	// the cells below keep their set, the others get a new one
+	uint32_t sets = 0;
+	for (int x = 0; x < _cols; x++) {
+		if (!_bottom[x]) {
+			uint32_t set = _set[x];
+			if (_label[set] == NONE) {
+				_label[set] = sets++;
+			}
+			_set[x] = _label[set];
+		} else {
+			_set[x] = NONE;
+		}
+	}
+	for (int x = 0; x < _cols; x++) {
+		if (_set[x] == NONE) {
+			_set[x] = sets++;
+		}
+	}
+
+	std::fill(_count.begin(), _count.end(), 0);
+	std::fill(_label.begin(), _label.end(), NONE);
+	std::fill(_down.begin(), _down.end(), 0);
+}
+
+// ###############################################
+// MazeGenerator
+// ###############################################
+
+MazeGenerator::MazeGenerator(int cols, int rows, unsigned int seed) :
+	_cols(cols),
+	_rows(rows),
+	_horbias(1),
+	_verbias(1),
+	_rng(seed),
+	_eller(cols)
+{
+	size_t words = ((size_t)cols * rows + 63) / 64;
+	_right = std::vector<uint64_t>(words, ~(uint64_t)0);
+	_bottom = std::vector<uint64_t>(words, ~(uint64_t)0);
+	_visited = std::vector<uint64_t>(words, 0);
+}
+
+MazeGenerator::~MazeGenerator()
+{
+
+}
+
+bool MazeGenerator::wall(int x, int y, Side side) const
+{
+	if (x < 0 || y < 0 || x >= _cols || y >= _rows) {
+		return true;
+	}
+	size_t cell = (size_t)y * _cols + x;
+	switch (side) {
+		case TOP: return y == 0 || bit(_bottom, cell - _cols);
+		case RIGHT: return x == _cols - 1 || bit(_right, cell);
+		case BOTTOM: return y == _rows - 1 || bit(_bottom, cell);
+		case LEFT: return x == 0 || bit(_right, cell - 1);
+	}
+	return true;
+}
+
+uint8_t MazeGenerator::walls(int x, int y) const
+{
+	uint8_t walls = 0;
+	if (wall(x, y, TOP)) { walls |= TOP; }
+	if (wall(x, y, RIGHT)) { walls |= RIGHT; }
+	if (wall(x, y, BOTTOM)) { walls |= BOTTOM; }
+	if (wall(x, y, LEFT)) { walls |= LEFT; }
+	return walls;
+}
+
+uint32_t MazeGenerator::neighbour(uint32_t cell, int direction) const
+{
+	int x = cell % _cols;
+	int y = cell / _cols;
+	switch (direction) {
+		case 0: return y > 0 ? cell - _cols : NONE;
+		case 1: return x < _cols - 1 ? cell + 1 : NONE;
+		case 2: return y < _rows - 1 ? cell + _cols : NONE;
+		case 3: return x > 0 ? cell - 1 : NONE;
+	}
+	return NONE;
+}
+
+void MazeGenerator::carve(uint32_t cell, int direction)
+{
+	switch (direction) {
+		case 0: clearbit(_bottom, cell - _cols); break;
+		case 1: clearbit(_right, cell); break;
+		case 2: clearbit(_bottom, cell); break;
+		case 3: clearbit(_right, cell - 1); break;
+	}
+}
+
+uint32_t MazeGenerator::find(uint32_t a)
+{
+	while (_parent[a] != a) {
+		_parent[a] = _parent[_parent[a]];
+		a = _parent[a];
+	}
+	return a;
+}
+
+void MazeGenerator::generate(Algorithm algorithm)
+{
+	std::fill(_right.begin(), _right.end(), ~(uint64_t)0);
+	std::fill(_bottom.begin(), _bottom.end(), ~(uint64_t)0);
+	std::fill(_visited.begin(), _visited.end(), 0);
+
+	switch (algorithm) {
+		case BACKTRACKER: backtracker(); break;
+		case WILSON: wilson(); break;
+		case KRUSKAL: kruskal(); break;
+		case ELLER: eller(); break;
+	}
+}
+
+void MazeGenerator::backtracker()
+{
+	_stack.reserve((size_t)_cols * _rows);
+	_stack.clear();
+	setbit(_visited, 0);
+	_stack.push_back(0);
+
+	while (!_stack.empty()) {
+		uint32_t cell = _stack.back();
+
+		// unvisited neighbours, as often as their bias
+		int directions[4];
+		int weights[4];
+		int count = 0;
+		int total = 0;
+		for (int d = 0; d < 4; d++) {
+			uint32_t n = neighbour(cell, d);
+			if (n != NONE && !bit(_visited, n)) {
+				directions[count] = d;
+				weights[count] = (d & 1) ? _horbias : _verbias;
+				total += weights[count];
+				count++;
+			}
+		}
+
+		// stuck: backtrack
+		if (count == 0 || total <= 0) {
+			_stack.pop_back();
+			continue;
+		}
+
+		int r = random(total);
+		int i = 0;
+		while (r >= weights[i]) {
+			r -= weights[i];
+			i++;
+		}
+		uint32_t next = neighbour(cell, directions[i]);
+		carve(cell, directions[i]);
+		setbit(_visited, next);
+		_stack.push_back(next);
+	}
+}
+
+void MazeGenerator::wilson()
+{
+	size_t cells = (size_t)_cols * _rows;
+	_direction.resize(cells);
+	setbit(_visited, random(cells));
+
+	for (size_t start = 0; start < cells; start++) {
+		// walk until we hit the maze, remembering the last way out of every cell: that erases the loops
+		uint32_t cell = start;
+		while (!bit(_visited, cell)) {
+			int d;
+			uint32_t n;
+			do {
+				d = _rng() & 3;
+				n = neighbour(cell, d);
+			} while (n == NONE);
+			_direction[cell] = d;
+			cell = n;
+		}
+
+		// and carve it
+		cell = start;
+		while (!bit(_visited, cell)) {
+			setbit(_visited, cell);
+			carve(cell, _direction[cell]);
+			cell = neighbour(cell, _direction[cell]);
+		}
+	}
+}
+
+void MazeGenerator::kruskal()
+{
+	size_t cells = (size_t)_cols * _rows;
+	_parent.resize(cells);
+	_edges.clear();
+	_edges.reserve(cells * 2);
+	for (size_t cell = 0; cell < cells; cell++) {
+		_parent[cell] = cell;
+		if ((int)(cell % _cols) < _cols - 1) { _edges.push_back(cell * 2); }
+		if ((int)(cell / _cols) < _rows - 1) { _edges.push_back(cell * 2 + 1); }
+	}
+	for (size_t i = _edges.size(); i > 1; i--) {
+		std::swap(_edges[i - 1], _edges[random(i)]);
+	}
+
+	size_t joined = 0;
+	for (size_t i = 0; i < _edges.size() && joined + 1 < cells; i++) {
+		uint32_t cell = _edges[i] / 2;
+		int direction = (_edges[i] & 1) ? 2 : 1;
+		uint32_t a = find(cell);
+		uint32_t b = find(neighbour(cell, direction));
+		if (a != b) {
+			_parent[a] = b;
+			carve(cell, direction);
+			joined++;
+		}
+	}
+}
+
+void MazeGenerator::eller()
+{
+	_eller.seed(_rng());
+	_eller.reset();
+	for (int y = 0; y < _rows; y++) {
+		_eller.next(y == _rows - 1);
+		const std::vector<uint8_t>& right = _eller.right();
+		const std::vector<uint8_t>& bottom = _eller.bottom();
+		size_t cell = (size_t)y * _cols;
+		for (int x = 0; x < _cols; x++, cell++) {
+			if (!right[x]) { clearbit(_right, cell); }
+			if (!bottom[x]) { clearbit(_bottom, cell); }
+		}
+	}
+}
+
+void MazeGenerator::render(rt::PixelBuffer& pixelbuffer) const
+{
+	int width = _cols * 2 + 1;
+	if (pixelbuffer.width() != width || pixelbuffer.height() != _rows * 2 + 1) {
+		return;
+	}
+	std::vector<rt::RGBAColor>& pixels = pixelbuffer.pixels();
+	std::fill(pixels.begin(), pixels.end(), BLACK);
+	for (int y = 0; y < _rows; y++) {
+		for (int x = 0; x < _cols; x++) {
+			size_t cell = (size_t)y * _cols + x;
+			size_t pixel = (size_t)(y * 2 + 1) * width + x * 2 + 1;
+			pixels[pixel] = WHITE;
+			if (x < _cols - 1 && !bit(_right, cell)) { pixels[pixel + 1] = WHITE; }
+			if (y < _rows - 1 && !bit(_bottom, cell)) { pixels[pixel + width] = WHITE; }
+		}
+	}
+}
+
+} // namespace cnv
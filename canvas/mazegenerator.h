@@ -0,0 +1,158 @@
+/**
+ * @file mazegenerator.h
+ * @brief cnv::MazeGenerator header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef MAZEGENERATOR_H
+#define MAZEGENERATOR_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <pixelbuffer/pixelbuffer.h>
+
+namespace cnv {
+
+/// @brief Eller's algorithm, a row of cells at a time: only the sets of the current row are kept.
+/// Every row is linked to the rows above by at least one passage down per set, so any number of rows
+/// can be made, and written out, as they come.
+class EllerGenerator
+{
+public:
+	/// @param cols number of cells in a row
+	/// @param seed for the random numbers
+	EllerGenerator(int cols, unsigned int seed = 0);
+	virtual ~EllerGenerator();
+
+	int cols() const { return _cols; }
+
+	/// @brief start a new maze: every cell of the first row in a set of its own
+	void reset();
+	void seed(unsigned int seed) { _rng.seed(seed); }
+
+	/// @brief carve the next row
+	/// @param last the bottom row: join all sets, nothing goes down
+	void next(bool last);
+
+	/// @brief walls of the row that was just carved: 1 for a wall at the right of cell x
+	const std::vector<uint8_t>& right() const { return _right; }
+	/// @brief 1 for a wall below cell x
+	const std::vector<uint8_t>& bottom() const { return _bottom; }
+
+private:
+	int _cols;
+	std::mt19937 _rng;
+
+	std::vector<uint32_t> _set; // set of each cell in the row
+	std::vector<uint32_t> _parent; // union-find of the sets in this row
+	std::vector<uint32_t> _count; // cells of a set seen so far
+	std::vector<uint32_t> _chosen; // the cell of a set that goes down, if none did
+	std::vector<uint32_t> _label; // set in the next row
+	std::vector<uint8_t> _down; // a cell of the set goes down
+	std::vector<uint8_t> _right;
+	std::vector<uint8_t> _bottom;
+
+	uint32_t _coins; // random bits
+	int _coinsleft;
+
+	uint32_t find(uint32_t a);
+	bool coin()
+	{
+		if (_coinsleft == 0) {
+			_coins = _rng();
+			_coinsleft = 32;
+		}
+		_coinsleft--;
+		bool heads = _coins & 1;
+		_coins >>= 1;
+		return heads;
+	}
+};
+
+/// @brief Perfect mazes (a single path between any two cells) on a grid of cells.
+/// The walls are two bits per cell, right and bottom (left and top are those of the neighbours).
+/// What an algorithm needs is allocated when it first runs, and kept.
+class MazeGenerator
+{
+public:
+	/// @brief how to carve the maze
+	enum Algorithm
+	{
+		BACKTRACKER, // depth first, long winding corridors
+		WILSON, // loop-erased random walks, an unbiased maze
+		KRUSKAL, // random walls removed if it doesn't make a loop, many short dead ends
+		ELLER // row by row
+	};
+
+	/// @brief sides of a cell, same bits as the walls of the MCell in the demos
+	enum Side
+	{
+		TOP = 1,
+		RIGHT = 2,
+		BOTTOM = 4,
+		LEFT = 8
+	};
+
+	/// @brief a maze with all walls up
+	/// @param cols number of cells wide
+	/// @param rows number of cells high
+	/// @param seed for the random numbers
+	MazeGenerator(int cols, int rows, unsigned int seed = 0);
+	virtual ~MazeGenerator();
+
+	int cols() const { return _cols; }
+	int rows() const { return _rows; }
+
+	/// @brief how often the backtracker picks horizontal and vertical neighbours (1, 1: the same)
+	void setBias(int horizontal, int vertical) { _horbias = horizontal; _verbias = vertical; }
+	void seed(unsigned int seed) { _rng.seed(seed); }
+
+	/// @brief carve a new maze
+	void generate(Algorithm algorithm);
+
+	/// @brief is there a wall at this side of the cell. Around the maze there is.
+	bool wall(int x, int y, Side side) const;
+	/// @brief all walls of the cell, a Side per bit
+	uint8_t walls(int x, int y) const;
+
+	/// @brief draw the maze in a pixelbuffer of (2*cols+1) x (2*rows+1), passages WHITE, walls BLACK
+	void render(rt::PixelBuffer& pixelbuffer) const;
+
+private:
+	int _cols;
+	int _rows;
+	int _horbias;
+	int _verbias;
+	std::mt19937 _rng;
+
+	std::vector<uint64_t> _right; // walls, a bit per cell
+	std::vector<uint64_t> _bottom;
+	std::vector<uint64_t> _visited; // or 'in the maze'
+
+	std::vector<uint32_t> _stack; // backtracker
+	std::vector<uint8_t> _direction; // Wilson: where the walk went from a cell
+	std::vector<uint32_t> _parent; // Kruskal: union-find
+	std::vector<uint32_t> _edges; // Kruskal: cell * 2 + (0 right, 1 bottom)
+	EllerGenerator _eller;
+
+	static bool bit(const std::vector<uint64_t>& bits, size_t index) { return (bits[index / 64] >> (index % 64)) & 1; }
+	static void setbit(std::vector<uint64_t>& bits, size_t index) { bits[index / 64] |= (uint64_t)1 << (index % 64); }
+	static void clearbit(std::vector<uint64_t>& bits, size_t index) { bits[index / 64] &= ~((uint64_t)1 << (index % 64)); }
+
+	uint32_t random(uint32_t n) { return _rng() % n; }
+	uint32_t find(uint32_t a);
+	/// @brief open the wall between a cell and its neighbour in a direction (0 up, 1 right, 2 down, 3 left)
+	void carve(uint32_t cell, int direction);
+	uint32_t neighbour(uint32_t cell, int direction) const;
+
+	void backtracker();
+	void wilson();
+	void kruskal();
+	void eller();
+};
+
+} // namespace cnv
+
+#endif /* MAZEGENERATOR_H */
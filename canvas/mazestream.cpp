@@ -0,0 +1,110 @@
+/**
+ * @file mazestream.cpp
+ * @brief cnv::MazeStream implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <algorithm>
+
+#include <canvas/mazestream.h>
+
+namespace cnv {
+
+MazeStream::MazeStream(uint32_t cols, uint32_t rows, unsigned int seed) :
+	_cols(cols),
+	_rows(rows),
+	_eller(cols, seed)
+{
+	uint64_t width = (uint64_t)_cols * 2 + 1;
+	_walls = std::vector<uint8_t>(width, 1);
+	_bytes = std::vector<char>(format() == PBF ? width * 3 : (width + 7) / 8, 0);
+}
+
+MazeStream::~MazeStream()
+{
+
+}
+
+MazeStream::Format MazeStream::format() const
+{
+	uint64_t width = (uint64_t)_cols * 2 + 1;
+	uint64_t height = (uint64_t)_rows * 2 + 1;
+	return (width <= 0xFFFF && height <= 0xFFFF) ? PBF : PBM;
+}
+
+void MazeStream::writeRow(std::ofstream& out, uint64_t y, Format format)
+{
+	uint64_t width = _walls.size();
+	if (format == PBF) {
+		for (uint64_t x = 0; x < width; x++) {
+			rt::RGBAColor color = _walls[x] ? BLACK : WHITE;
+			if (x == 1 && y == 1) { color = RED; } // start
+			if (x == width - 2 && y == (uint64_t)_rows * 2 - 1) { color = BLUE; } // end
+			_bytes[x * 3 + 0] = color.r;
+			_bytes[x * 3 + 1] = color.g;
+			_bytes[x * 3 + 2] = color.b;
+		}
+	} else {
+		// 8 pixels per byte, the first one in the high bit
+		std::fill(_bytes.begin(), _bytes.end(), 0);
+		for (uint64_t x = 0; x < width; x++) {
+			if (_walls[x]) {
+				_bytes[x / 8] |= 0x80 >> (x % 8);
+			}
+		}
+	}
+	out.write(_bytes.data(), _bytes.size());
+}
+
+bool MazeStream::write(const std::string& filename)
+{
+	std::ofstream out(filename, std::ios::binary);
+	if (!out) {
+		return false;
+	}
+
+	uint64_t width = (uint64_t)_cols * 2 + 1;
+	uint64_t height = (uint64_t)_rows * 2 + 1;
+	Format f = format();
+	if (f == PBF) {
+		// 'p' 'b' width height (16 bits, little endian) bitdepth ':'
+		char header[8] = { 'p', 'b',
+			(char)(width & 0xFF), (char)(width >> 8),
+			(char)(height & 0xFF), (char)(height >> 8),
+			24, ':' };
+		out.write(header, 8);
+	} else {
+		out << "P4\n" << width << " " << height << "\n";
+	}
+
+	// the wall at the top
+	std::fill(_walls.begin(), _walls.end(), 1);
+	writeRow(out, 0, f);
+
+	_eller.reset();
+	for (uint32_t row = 0; row < _rows; row++) {
+		bool last = row == _rows - 1;
+		_eller.next(last);
+		const std::vector<uint8_t>& right = _eller.right();
+		const std::vector<uint8_t>& bottom = _eller.bottom();
+
+		// the cells, and the walls between them
+		_walls[0] = 1;
+		for (uint32_t x = 0; x < _cols; x++) {
+			_walls[x * 2 + 1] = 0;
+			_walls[x * 2 + 2] = (x == _cols - 1) || right[x];
+		}
+		writeRow(out, (uint64_t)row * 2 + 1, f);
+
+		// the walls below them
+		for (uint32_t x = 0; x < _cols; x++) {
+			_walls[x * 2 + 1] = last || bottom[x];
+			_walls[x * 2 + 2] = 1;
+		}
+		writeRow(out, (uint64_t)row * 2 + 2, f);
+	}
+
+	return out.good();
+}
+
+} // namespace cnv
@@ -0,0 +1,64 @@
+/**
+ * @file mazestream.h
+ * @brief cnv::MazeStream header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef MAZESTREAM_H
+#define MAZESTREAM_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <canvas/mazegenerator.h>
+
+namespace cnv {
+
+/// @brief Writes a maze to a file while it's being made, a row at a time (Eller's algorithm).
+/// Only a row of cells and a row of pixels are in memory, so the size of the maze is limited by the disk.
+/// The image is (2*cols+1) x (2*rows+1), like MazeGenerator::render(): a PBF file (24 bits, start RED
+/// at 1,1, end BLUE at the bottom right) when that fits in its 16 bit width and height, or a
+/// PBM file (P4, a bit per pixel, 1 is a wall) when it doesn't.
+class MazeStream
+{
+public:
+	enum Format
+	{
+		PBF,
+		PBM
+	};
+
+	/// @param cols number of cells wide
+	/// @param rows number of cells high
+	/// @param seed for the random numbers
+	MazeStream(uint32_t cols, uint32_t rows, unsigned int seed = 0);
+	virtual ~MazeStream();
+
+	uint32_t cols() const { return _cols; }
+	uint32_t rows() const { return _rows; }
+	void seed(unsigned int seed) { _eller.seed(seed); }
+
+	/// @brief the format write() uses for this size
+	Format format() const;
+
+	/// @brief make a new maze, and write it
+	/// @param filename the file
+	/// @return false if the file couldn't be written
+	bool write(const std::string& filename);
+
+private:
+	uint32_t _cols;
+	uint32_t _rows;
+	EllerGenerator _eller;
+
+	std::vector<uint8_t> _walls; // a pixel row, 1 for a wall
+	std::vector<char> _bytes; // the same row, in the format of the file
+
+	void writeRow(std::ofstream& out, uint64_t y, Format format);
+};
+
+} // namespace cnv
+
+#endif /* MAZESTREAM_H */
@@ -17,15 +17,17 @@
 #include <algorithm>
 #include <numeric>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include <canvas/noise.h>
+#include <canvas/parallel.h>
 
 namespace cnv {
 
-// Initialize with the reference values for the permutation vector
-PerlinNoise::PerlinNoise() {
-
-	// Initialize the permutation vector with the reference values
-	p = {
+// The reference values for the permutation table
+static const uint8_t permutation[256] = {
 		151,160,137,91,90,15,131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,
 		8,99,37,240,21,10,23,190, 6,148,247,120,234,75,0,26,197,62,94,252,219,203,117,
 		35,11,32,57,177,33,88,237,149,56,87,174,20,125,136,171,168, 68,175,74,165,71,
@@ -38,25 +40,44 @@ PerlinNoise::PerlinNoise() {
 		97,228,251,34,242,193,238,210,144,12,191,179,162,241, 81,51,145,235,249,14,239,
 		107,49,192,214, 31,181,199,106,157,184, 84,204,176,115,121,50,45,127, 4,150,254,
 		138,236,205,93,222,114,67,29,24,72,243,141,128,195,78,66,215,61,156,180 };
-	// Duplicate the permutation vector
-	p.insert(p.end(), p.begin(), p.end());
+
+// The 16 gradients of grad(), as (x, y, z)
+static const float gradients[16][3] = {
+	{ 1, 1, 0}, {-1, 1, 0}, { 1,-1, 0}, {-1,-1, 0},
+	{ 1, 0, 1}, {-1, 0, 1}, { 1, 0,-1}, {-1, 0,-1},
+	{ 0, 1, 1}, { 0,-1, 1}, { 0, 1,-1}, { 0,-1,-1},
+	{ 1, 1, 0}, { 0,-1, 1}, {-1, 1, 0}, { 0,-1,-1}
+};
+
+static inline float fadef(float t) {
+	return t * t * t * (t * (t * 6 - 15) + 10);
+}
+
+// Initialize with the reference values for the permutation table
+PerlinNoise::PerlinNoise() {
+	// Duplicate the permutation table
+	for (int i = 0; i < 512; i++) {
+		p[i] = permutation[i & 255];
+	}
 }
 
 // Generate a new permutation vector based on the value of seed
 PerlinNoise::PerlinNoise(unsigned int seed) {
-	p.resize(256);
+	std::vector<int> values(256);
 
-	// Fill p with values from 0 to 255
-	std::iota(p.begin(), p.end(), 0);
+	// Fill values from 0 to 255
+	std::iota(values.begin(), values.end(), 0);
 
 	// Initialize a random engine with seed
 	std::default_random_engine engine(seed);
 
 	// Suffle  using the above random engine
-	std::shuffle(p.begin(), p.end(), engine);
+	std::shuffle(values.begin(), values.end(), engine);
 
-	// Duplicate the permutation vector
-	p.insert(p.end(), p.begin(), p.end());
+	// Duplicate the permutation table
+	for (int i = 0; i < 512; i++) {
+		p[i] = values[i & 255];
+	}
 }
 
 double PerlinNoise::noise(double x, double y, double z) {
@@ -108,4 +129,122 @@ double PerlinNoise::grad(int hash, double x, double y, double z) {
 	return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
 }
 
+void PerlinNoise::addOctave(float* out, size_t count, float x0, float dx, float y, float z, float amplitude) const {
+	// The whole row is in the same unit cube in y and z
+	float fy = std::floor(y);
+	float fz = std::floor(z);
+	int Y = (int) fy & 255;
+	int Z = (int) fz & 255;
+	y -= fy;
+	z -= fz;
+	float v = fadef(y);
+	float w = fadef(z);
+
+	// Weights of the 4 corners in y and z: (0,0), (1,0), (0,1), (1,1)
+	const float weights[4] = { (1-v)*(1-w), v*(1-w), (1-v)*w, v*w };
+	const float ys[4] = { y, y-1, y, y-1 };
+	const float zs[4] = { z, z, z-1, z-1 };
+	const float half = amplitude * 0.5f;
+
+	size_t i = 0;
+	while (i < count) {
+		// The samples in this unit cube
+		float fx = std::floor(x0 + i * dx);
+		size_t end = count;
+		if (dx > 0.0f) {
+			end = std::min(count, std::max(i + 1, (size_t) std::ceil((fx + 1 - x0) / dx)));
+		}
+
+		// Hash coordinates of the 8 cube corners
+		int X = (int) fx & 255;
+		int A = p[X] + Y;
+		int AA = p[A] + Z;
+		int AB = p[A + 1] + Z;
+		int B = p[X + 1] + Y;
+		int BA = p[B] + Z;
+		int BB = p[B + 1] + Z;
+		const int left[4] = { p[AA], p[AB], p[AA+1], p[AB+1] };
+		const int right[4] = { p[BA], p[BB], p[BA+1], p[BB+1] };
+
+		// Blended over y and z, both sides of the cube are a line in x: a*x + b
+		float a0 = 0, b0 = 0, a1 = 0, b1 = 0;
+		for (int c = 0; c < 4; c++) {
+			const float* g = gradients[left[c] & 15];
+			a0 += weights[c] * g[0];
+			b0 += weights[c] * (g[1]*ys[c] + g[2]*zs[c]);
+			g = gradients[right[c] & 15];
+			a1 += weights[c] * g[0];
+			b1 += weights[c] * (-g[0] + g[1]*ys[c] + g[2]*zs[c]);
+		}
+
+		// Relative x of sample j is start + j*dx
+		float start = x0 - fx;
+		size_t j = i;
+#ifdef __SSE2__
+		const __m128 vstart = _mm_set1_ps(start);
+		const __m128 vdx = _mm_set1_ps(dx);
+		const __m128 va0 = _mm_set1_ps(a0), vb0 = _mm_set1_ps(b0);
+		const __m128 va1 = _mm_set1_ps(a1), vb1 = _mm_set1_ps(b1);
+		const __m128 vhalf = _mm_set1_ps(half);
+		const __m128 one = _mm_set1_ps(1.0f);
+		for (; j + 4 <= end; j += 4) {
+			__m128 index = _mm_cvtepi32_ps(_mm_set_epi32(j + 3, j + 2, j + 1, j));
+			__m128 x = _mm_add_ps(vstart, _mm_mul_ps(index, vdx));
+			// fade
+			__m128 u = _mm_sub_ps(_mm_mul_ps(x, _mm_set1_ps(6)), _mm_set1_ps(15));
+			u = _mm_add_ps(_mm_mul_ps(x, u), _mm_set1_ps(10));
+			u = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(x, x), x), u);
+			// lerp
+			__m128 l0 = _mm_add_ps(_mm_mul_ps(va0, x), vb0);
+			__m128 l1 = _mm_add_ps(_mm_mul_ps(va1, x), vb1);
+			__m128 res = _mm_add_ps(l0, _mm_mul_ps(u, _mm_sub_ps(l1, l0)));
+			res = _mm_mul_ps(vhalf, _mm_add_ps(res, one));
+			_mm_storeu_ps(out + j, _mm_add_ps(_mm_loadu_ps(out + j), res));
+		}
+#endif
+		for (; j < end; j++) {
+			float x = start + j * dx;
+			float u = fadef(x);
+			float l0 = a0 * x + b0;
+			float l1 = a1 * x + b1;
+			out[j] += half * (l0 + u * (l1 - l0) + 1);
+		}
+
+		i = end;
+	}
+}
+
+void PerlinNoise::fillRow(float* out, size_t count, float x0, float dx, float y, float z, const std::vector<Octave>& octaves) const {
+	std::fill(out, out + count, 0.0f);
+
+	float total = 0.0f;
+	for (size_t o = 0; o < octaves.size(); o++) {
+		float f = octaves[o].frequency;
+		addOctave(out, count, x0 * f, dx * f, y * f, z * f, octaves[o].amplitude);
+		total += octaves[o].amplitude;
+	}
+
+	if (total != 0.0f) {
+		float scale = 1.0f / total;
+		for (size_t i = 0; i < count; i++) {
+			out[i] *= scale;
+		}
+	}
+}
+
+void PerlinNoise::fillGrid(float* out, size_t cols, size_t rows, float x0, float dx, float y0, float dy, float z, const std::vector<Octave>& octaves, bool threaded) const {
+	if (!threaded) {
+		for (size_t y = 0; y < rows; y++) {
+			fillRow(out + y * cols, cols, x0, dx, y0 + y * dy, z, octaves);
+		}
+		return;
+	}
+
+	parallel_for_rows(rows, [&](const RowBand& band) {
+		for (size_t y = band.begin; y < band.end; y++) {
+			fillRow(out + y * cols, cols, x0, dx, y0 + y * dy, z, octaves);
+		}
+	}, cols * sizeof(float));
+}
+
 } // namespace cnv
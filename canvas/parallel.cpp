@@ -0,0 +1,166 @@
+/**
+ * @file parallel.cpp
+ * @brief cnv::ThreadPool, cnv::parallel_for, cnv::parallel_for_rows implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <algorithm>
+
+#include <canvas/parallel.h>
+
+namespace cnv {
+
+// set on the threads of a pool, so a job calling run() doesn't wait for itself
+static thread_local bool inpool = false;
+
+ThreadPool::ThreadPool(size_t threads) :
+	_job(nullptr),
+	_jobs(0),
+	_next(0),
+	_finished(0),
+	_active(0),
+	_generation(0),
+	_quit(false)
+{
+	if (threads == 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	for (size_t i = 1; i < threads; i++) {
+		_workers.push_back(std::thread(&ThreadPool::worker, this));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_quit = true;
+	}
+	_wake.notify_all();
+	for (auto& thread : _workers) {
+		thread.join();
+	}
+}
+
+ThreadPool& ThreadPool::instance()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+void ThreadPool::run(size_t jobs, const std::function<void(size_t)>& job)
+{
+	if (jobs == 0) {
+		return;
+	}
+
+	// nothing to share, or nobody to share it with right now
+	std::unique_lock<std::mutex> busy(_busy, std::defer_lock);
+	if (jobs == 1 || _workers.empty() || inpool || !busy.try_lock()) {
+		for (size_t i = 0; i < jobs; i++) {
+			job(i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_job = &job;
+		_jobs = jobs;
+		_next = 0;
+		_finished = 0;
+		_generation++;
+	}
+	_wake.notify_all();
+
+	// work along
+	inpool = true;
+	size_t done = work(job, jobs);
+	inpool = false;
+
+	// wait for the others, also the ones that were too late to find a job
+	std::unique_lock<std::mutex> lock(_mutex);
+	_finished += done;
+	_done.wait(lock, [&]{ return _finished == _jobs && _active == 0; });
+	_job = nullptr;
+}
+
+void ThreadPool::worker()
+{
+	inpool = true;
+	unsigned int seen = 0;
+	while (true) {
+		std::unique_lock<std::mutex> lock(_mutex);
+		_wake.wait(lock, [&]{ return _quit || (_generation != seen && _job != nullptr); });
+		if (_quit) {
+			return;
+		}
+		seen = _generation;
+		const std::function<void(size_t)>& job = *_job;
+		size_t jobs = _jobs;
+		_active++;
+		lock.unlock();
+
+		size_t done = work(job, jobs);
+
+		lock.lock();
+		_finished += done;
+		_active--;
+		if (_finished == _jobs && _active == 0) {
+			_done.notify_all();
+		}
+	}
+}
+
+size_t ThreadPool::work(const std::function<void(size_t)>& job, size_t jobs)
+{
+	size_t done = 0;
+	size_t i;
+	while ((i = _next++) < jobs) {
+		job(i);
+		done++;
+	}
+	return done;
+}
+
+void parallel_for(size_t count, const std::function<void(size_t begin, size_t end)>& fn, size_t grain)
+{
+	if (count == 0) {
+		return;
+	}
+
+	ThreadPool& pool = ThreadPool::instance();
+	if (grain == 0) {
+		// a few jobs per thread, so a slow one doesn't keep the others waiting
+		grain = std::max((size_t)1, count / (pool.size() * 4));
+	}
+	size_t jobs = (count + grain - 1) / grain;
+	pool.run(jobs, [&](size_t job) {
+		size_t begin = job * grain;
+		fn(begin, std::min(count, begin + grain));
+	});
+}
+
+void parallel_for_rows(size_t rows, const std::function<void(const RowBand& band)>& fn, size_t rowbytes)
+{
+	if (rows == 0) {
+		return;
+	}
+
+	ThreadPool& pool = ThreadPool::instance();
+	size_t bandrows = std::max((size_t)1, rows / (pool.size() * 4));
+	if (rowbytes > 0) {
+		// about half of a typical L2 cache for a band and its neighbour rows
+		const size_t cachebytes = 128 * 1024;
+		size_t fits = cachebytes / rowbytes;
+		fits = fits > 2 ? fits - 2 : 1;
+		bandrows = std::min(bandrows, fits);
+	}
+
+	parallel_for(rows, [&](size_t begin, size_t end) {
+		RowBand band = { begin, end, rows };
+		fn(band);
+	}, bandrows);
+}
+
+} // namespace cnv
@@ -0,0 +1,90 @@
+/**
+ * @file parallel.h
+ * @brief cnv::ThreadPool, cnv::parallel_for, cnv::parallel_for_rows header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cnv {
+
+/// @brief A fixed set of threads that stay around, so there's no thread creation in every update().
+/// The thread calling run() works along. run() can be called from any thread; when the pool is
+/// busy (another thread, or run() inside a job) the jobs just run on the calling thread.
+class ThreadPool
+{
+public:
+	/// @brief Start the threads
+	/// @param threads total number of threads, including the caller of run(). 0: one per core
+	ThreadPool(size_t threads = 0);
+	virtual ~ThreadPool();
+
+	/// @brief the pool that parallel_for() and parallel_for_rows() use
+	/// @return ThreadPool& the shared pool
+	static ThreadPool& instance();
+
+	/// @brief number of threads doing the work, including the caller of run()
+	/// @return size_t threads
+	size_t size() { return _workers.size() + 1; }
+
+	/// @brief call job(0) .. job(jobs-1) on all threads, returns when they are all done
+	/// @param jobs number of jobs
+	/// @param job the work, called once for each job number
+	void run(size_t jobs, const std::function<void(size_t)>& job);
+
+private:
+	std::vector<std::thread> _workers;
+
+	std::mutex _busy; // one run() at a time
+	std::mutex _mutex; // everything below
+	std::condition_variable _wake;
+	std::condition_variable _done;
+	const std::function<void(size_t)>* _job;
+	size_t _jobs;
+	std::atomic<size_t> _next;
+	size_t _finished;
+	size_t _active;
+	unsigned int _generation;
+	bool _quit;
+
+	void worker();
+	size_t work(const std::function<void(size_t)>& job, size_t jobs);
+};
+
+/// @brief Call fn(begin, end) for consecutive ranges of [0, count) on all threads
+/// @param count number of items
+/// @param fn the work for items begin .. end-1
+/// @param grain number of items per call. 0: a few calls per thread
+void parallel_for(size_t count, const std::function<void(size_t begin, size_t end)>& fn, size_t grain = 0);
+
+/// @brief A band of rows [begin, end) of a grid with `rows` rows
+struct RowBand
+{
+	size_t begin;
+	size_t end;
+	size_t rows;
+
+	/// @brief the row above y, wraps around to the bottom
+	size_t above(size_t y) const { return y == 0 ? rows - 1 : y - 1; }
+	/// @brief the row below y, wraps around to the top
+	size_t below(size_t y) const { return y + 1 == rows ? 0 : y + 1; }
+};
+
+/// @brief Call fn(band) for bands of rows on all threads.
+/// Bands are small enough for the rows they read (a band, plus one row above and below) to stay in cache.
+/// @param rows number of rows in the grid
+/// @param fn the work for band.begin .. band.end-1. Only write to your own rows.
+/// @param rowbytes bytes read per row, to size the bands. 0: just a few bands per thread
+void parallel_for_rows(size_t rows, const std::function<void(const RowBand& band)>& fn, size_t rowbytes = 0);
+
+} // namespace cnv
+
+#endif /* PARALLEL_H */
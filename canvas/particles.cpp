@@ -0,0 +1,277 @@
+/**
+ * @file particles.cpp
+ * @brief cnv::ParticleSystem implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <canvas/particles.h>
+#include <canvas/parallel.h>
+#include <canvas/trailcanvas.h>
+
+namespace cnv {
+
+ParticleSystem::ParticleSystem(size_t capacity, unsigned int seed) :
+	_used(0),
+	_count(0),
+	_rng(seed),
+	_gravity(rt::vec2f(0.0f, 0.0f)),
+	_friction(1.0f),
+	_huespeed(0.0f),
+	_field(nullptr),
+	_cellsize(1.0f),
+	_strength(0.0f),
+	_follow(0.0f),
+	_width(0.0f),
+	_height(0.0f),
+	_edge(NONE)
+{
+	_x = std::vector<float>(capacity, 0.0f);
+	_y = std::vector<float>(capacity, 0.0f);
+	_vx = std::vector<float>(capacity, 0.0f);
+	_vy = std::vector<float>(capacity, 0.0f);
+	_age = std::vector<float>(capacity, 0.0f);
+	_lifetime = std::vector<float>(capacity, 0.0f);
+	_hue = std::vector<float>(capacity, 0.0f);
+	_alive = std::vector<uint8_t>(capacity, 0);
+
+	// all hues, at full saturation
+	for (int i = 0; i < 256; i++) {
+		rt::HSVAColor hsva = rt::RGBA2HSVA(RED);
+		hsva.h = i / 256.0f;
+		hsva.s = 1;
+		hsva.v = 1;
+		_hues[i] = rt::HSVA2RGBA(hsva);
+	}
+}
+
+ParticleSystem::~ParticleSystem()
+{
+
+}
+
+int ParticleSystem::spawn(float x, float y, float vx, float vy, float lifetime, float hue)
+{
+	size_t index;
+	if (!_free.empty()) {
+		index = _free.back();
+		_free.pop_back();
+	} else if (_used < _x.size()) {
+		index = _used++;
+	} else {
+		return -1;
+	}
+
+	_x[index] = x;
+	_y[index] = y;
+	_vx[index] = vx;
+	_vy[index] = vy;
+	_age[index] = 0.0f;
+	_lifetime[index] = lifetime;
+	_hue[index] = hue;
+	_alive[index] = 1;
+	_count++;
+	return index;
+}
+
+void ParticleSystem::kill(size_t index)
+{
+	if (index >= _used || !_alive[index]) {
+		return;
+	}
+	_alive[index] = 0;
+	_free.push_back(index);
+	_count--;
+}
+
+void ParticleSystem::clear()
+{
+	std::fill(_alive.begin(), _alive.end(), 0);
+	_free.clear();
+	_used = 0;
+	_count = 0;
+}
+
+size_t ParticleSystem::addEmitter(const Emitter& emitter)
+{
+	_emitters.push_back(emitter);
+	return _emitters.size() - 1;
+}
+
+void ParticleSystem::emit(const Emitter& emitter, size_t count)
+{
+	std::uniform_real_distribution<float> random(-0.5f, 0.5f);
+	for (size_t i = 0; i < count; i++) {
+		float x = emitter.position.x + random(_rng) * emitter.area.x;
+		float y = emitter.position.y + random(_rng) * emitter.area.y;
+		float vx = emitter.velocity.x + random(_rng) * emitter.spread.x;
+		float vy = emitter.velocity.y + random(_rng) * emitter.spread.y;
+		if (spawn(x, y, vx, vy, emitter.lifetime, emitter.hue) < 0) {
+			return;
+		}
+	}
+}
+
+void ParticleSystem::setFlowField(const FlowField* field, float cellsize, float strength, float follow)
+{
+	_field = field;
+	_cellsize = cellsize;
+	_strength = strength;
+	_follow = follow;
+}
+
+void ParticleSystem::setBounds(float width, float height, Edge edge)
+{
+	_width = width;
+	_height = height;
+	_edge = edge;
+}
+
+void ParticleSystem::move(size_t begin, size_t end, float dt, std::vector<uint32_t>& died)
+{
+	// follow the flowfield, one particle at a time
+	if (_field != nullptr) {
+		for (size_t i = begin; i < end; i++) {
+			if (!_alive[i]) { continue; }
+			rt::vec2f flow = _field->sample(_x[i] / _cellsize, _y[i] / _cellsize);
+			_vx[i] += (flow.x * _strength - _vx[i]) * _follow;
+			_vy[i] += (flow.y * _strength - _vy[i]) * _follow;
+		}
+	}
+
+	// move, dead ones too: that's cheaper than skipping them
+	float gx = _gravity.x * dt;
+	float gy = _gravity.y * dt;
+	float friction = _friction;
+	float huespeed = _huespeed;
+	size_t i = begin;
+#ifdef __SSE2__
+	const __m128 vdt = _mm_set1_ps(dt);
+	const __m128 vgx = _mm_set1_ps(gx);
+	const __m128 vgy = _mm_set1_ps(gy);
+	const __m128 vfriction = _mm_set1_ps(friction);
+	const __m128 vhuespeed = _mm_set1_ps(huespeed);
+	for (; i + 4 <= end; i += 4) {
+		__m128 vx = _mm_loadu_ps(&_vx[i]);
+		__m128 vy = _mm_loadu_ps(&_vy[i]);
+		_mm_storeu_ps(&_x[i], _mm_add_ps(_mm_loadu_ps(&_x[i]), _mm_mul_ps(vx, vdt)));
+		_mm_storeu_ps(&_y[i], _mm_add_ps(_mm_loadu_ps(&_y[i]), _mm_mul_ps(vy, vdt)));
+		_mm_storeu_ps(&_vx[i], _mm_mul_ps(_mm_add_ps(vx, vgx), vfriction));
+		_mm_storeu_ps(&_vy[i], _mm_mul_ps(_mm_add_ps(vy, vgy), vfriction));
+		_mm_storeu_ps(&_age[i], _mm_add_ps(_mm_loadu_ps(&_age[i]), vdt));
+		_mm_storeu_ps(&_hue[i], _mm_add_ps(_mm_loadu_ps(&_hue[i]), vhuespeed));
+	}
+#endif
+	for (; i < end; i++) {
+		_x[i] += _vx[i] * dt;
+		_y[i] += _vy[i] * dt;
+		_vx[i] = (_vx[i] + gx) * friction;
+		_vy[i] = (_vy[i] + gy) * friction;
+		_age[i] += dt;
+		_hue[i] += huespeed;
+	}
+
+	// lifetimes and edges
+	for (i = begin; i < end; i++) {
+		if (!_alive[i]) { continue; }
+		_hue[i] -= std::floor(_hue[i]);
+
+		bool dead = _lifetime[i] > 0.0f && _age[i] >= _lifetime[i];
+		if (_edge == BOUNCE) {
+			if (_y[i] > _height) { _y[i] = _height - 1; _vy[i] *= -1; }
+			if (_x[i] > _width) { _x[i] = _width - 1; _vx[i] *= -1; }
+			if (_x[i] < 0) { _x[i] = 0; _vx[i] *= -1; }
+			if (_y[i] < 0) { _y[i] = 0; _vy[i] *= -1; }
+		} else if (_edge == WRAP) {
+			if (_x[i] < 0) { _x[i] += _width; }
+			if (_x[i] >= _width) { _x[i] -= _width; }
+			if (_y[i] < 0) { _y[i] += _height; }
+			if (_y[i] >= _height) { _y[i] -= _height; }
+		} else if (_edge == KILL) {
+			dead = dead || _x[i] < 0 || _x[i] >= _width || _y[i] < 0 || _y[i] >= _height;
+		}
+
+		if (dead) {
+			_alive[i] = 0;
+			died.push_back(i);
+		}
+	}
+}
+
+void ParticleSystem::update(float dt)
+{
+	for (size_t e = 0; e < _emitters.size(); e++) {
+		Emitter& emitter = _emitters[e];
+		emitter.due += emitter.rate * dt;
+		size_t count = emitter.due;
+		emitter.due -= count;
+		emit(emitter, count);
+	}
+
+	// the free list is only touched at the end of a chunk
+	std::mutex mutex;
+	parallel_for(_used, [&](size_t begin, size_t end) {
+		std::vector<uint32_t> died;
+		move(begin, end, dt, died);
+		if (!died.empty()) {
+			std::lock_guard<std::mutex> lock(mutex);
+			_free.insert(_free.end(), died.begin(), died.end());
+			_count -= died.size();
+		}
+	}, 16384);
+}
+
+void ParticleSystem::render(rt::PixelBuffer& pixelbuffer) const
+{
+	int cols = pixelbuffer.width();
+	int rows = pixelbuffer.height();
+	std::vector<rt::RGBAColor>& pixels = pixelbuffer.pixels();
+	for (size_t i = 0; i < _used; i++) {
+		if (!_alive[i] || _x[i] < 0 || _y[i] < 0) { continue; }
+		int x = _x[i];
+		int y = _y[i];
+		if (x < cols && y < rows) {
+			pixels[y * cols + x] = _hues[(int)(_hue[i] * 256) & 255];
+		}
+	}
+}
+
+void ParticleSystem::render(rt::PixelBuffer& pixelbuffer, const rt::RGBAColor& color) const
+{
+	int cols = pixelbuffer.width();
+	int rows = pixelbuffer.height();
+	std::vector<rt::RGBAColor>& pixels = pixelbuffer.pixels();
+	for (size_t i = 0; i < _used; i++) {
+		if (!_alive[i] || _x[i] < 0 || _y[i] < 0) { continue; }
+		int x = _x[i];
+		int y = _y[i];
+		if (x < cols && y < rows) {
+			pixels[y * cols + x] = color;
+		}
+	}
+}
+
+void ParticleSystem::splat(TrailCanvas& trails, float intensity) const
+{
+	for (size_t i = 0; i < _used; i++) {
+		if (!_alive[i]) { continue; }
+		trails.splat(_x[i], _y[i], _hues[(int)(_hue[i] * 256) & 255], intensity);
+	}
+}
+
+void ParticleSystem::splat(TrailCanvas& trails, const rt::RGBAColor& color, float intensity) const
+{
+	for (size_t i = 0; i < _used; i++) {
+		if (!_alive[i]) { continue; }
+		trails.splat(_x[i], _y[i], color, intensity);
+	}
+}
+
+} // namespace cnv
@@ -0,0 +1,142 @@
+/**
+ * @file particles.h
+ * @brief cnv::ParticleSystem header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <pixelbuffer/pixelbuffer.h>
+
+#include <canvas/flowfield.h>
+
+namespace cnv {
+
+class TrailCanvas;
+
+/// @brief A pool of particles, a float array per property (x, y, vx, vy, ...).
+/// Dead particles go on a free list, new ones take their place. Moving them runs in chunks on
+/// the ThreadPool, 4 particles at a time (SSE2).
+class ParticleSystem
+{
+public:
+	/// @brief what happens at the bounds
+	enum Edge
+	{
+		NONE, // nothing
+		BOUNCE, // back in, the other way
+		WRAP, // in at the other side
+		KILL // dead
+	};
+
+	/// @brief spawns particles in an area, with a random velocity
+	struct Emitter
+	{
+		rt::vec2f position = rt::vec2f(0.0f, 0.0f); // center of the area
+		rt::vec2f area = rt::vec2f(0.0f, 0.0f); // width and height of the area
+		rt::vec2f velocity = rt::vec2f(0.0f, 0.0f); // average velocity
+		rt::vec2f spread = rt::vec2f(0.0f, 0.0f); // velocity is velocity -spread/2 .. +spread/2
+		float rate = 0.0f; // particles per second, in update()
+		float lifetime = 0.0f; // seconds, 0 for ever
+		float hue = 0.0f; // 0.0 - 1.0
+		float due = 0.0f; // particles not spawned yet
+	};
+
+	/// @brief an empty pool
+	/// @param capacity number of particles, at most
+	/// @param seed for the emitters
+	ParticleSystem(size_t capacity, unsigned int seed = 0);
+	virtual ~ParticleSystem();
+
+	size_t capacity() const { return _x.size(); }
+	/// @brief number of particles alive
+	size_t count() const { return _count; }
+
+	/// @brief a new particle
+	/// @return its index, -1 when the pool is full
+	int spawn(float x, float y, float vx, float vy, float lifetime = 0.0f, float hue = 0.0f);
+	/// @brief kill a particle
+	void kill(size_t index);
+	/// @brief kill all particles
+	void clear();
+
+	/// @brief add an emitter, spawning in update()
+	/// @return its index
+	size_t addEmitter(const Emitter& emitter);
+	Emitter& emitter(size_t index) { return _emitters[index]; }
+	/// @brief spawn a number of particles from an emitter at once
+	void emit(const Emitter& emitter, size_t count);
+
+	/// @brief added to the velocity, per second
+	void setGravity(float x, float y) { _gravity = rt::vec2f(x, y); }
+	/// @brief velocity is multiplied by this every update
+	void setFriction(float friction) { _friction = friction; }
+	/// @brief hue change every update
+	void setHueSpeed(float speed) { _huespeed = speed; }
+	/// @brief the velocity follows the flowfield: v += (flow*strength - v) * follow
+	/// @param field the flowfield, or nullptr for none
+	/// @param cellsize pixels per cell of the field
+	/// @param strength length of the velocity to follow
+	/// @param follow 0.0 - 1.0, how much of it every update
+	void setFlowField(const FlowField* field, float cellsize, float strength, float follow = 1.0f);
+	/// @brief bounds of the particles
+	void setBounds(float width, float height, Edge edge);
+
+	/// @brief spawn from the emitters, move all particles, and age them
+	/// @param dt time step in seconds
+	void update(float dt);
+
+	/// @brief draw every particle as a pixel, its hue at full saturation
+	void render(rt::PixelBuffer& pixelbuffer) const;
+	/// @brief draw every particle as a pixel in a color
+	void render(rt::PixelBuffer& pixelbuffer, const rt::RGBAColor& color) const;
+	/// @brief add every particle to the trails at its sub-pixel position, its hue at full saturation
+	void splat(TrailCanvas& trails, float intensity = 1.0f) const;
+	/// @brief add every particle to the trails at its sub-pixel position, in a color
+	void splat(TrailCanvas& trails, const rt::RGBAColor& color, float intensity = 1.0f) const;
+
+	float x(size_t index) const { return _x[index]; }
+	float y(size_t index) const { return _y[index]; }
+	bool alive(size_t index) const { return _alive[index] != 0; }
+
+private:
+	std::vector<float> _x;
+	std::vector<float> _y;
+	std::vector<float> _vx;
+	std::vector<float> _vy;
+	std::vector<float> _age;
+	std::vector<float> _lifetime;
+	std::vector<float> _hue;
+	std::vector<uint8_t> _alive;
+
+	std::vector<uint32_t> _free; // slots of dead particles
+	size_t _used; // slots from here on were never used
+	size_t _count;
+
+	std::vector<Emitter> _emitters;
+	std::mt19937 _rng;
+
+	rt::vec2f _gravity;
+	float _friction;
+	float _huespeed;
+	const FlowField* _field;
+	float _cellsize;
+	float _strength;
+	float _follow;
+	float _width;
+	float _height;
+	Edge _edge;
+
+	rt::RGBAColor _hues[256];
+
+	void move(size_t begin, size_t end, float dt, std::vector<uint32_t>& died);
+};
+
+} // namespace cnv
+
+#endif /* PARTICLES_H */
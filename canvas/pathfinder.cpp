@@ -0,0 +1,321 @@
+/**
+ * @file pathfinder.cpp
+ * @brief cnv::Pathfinder implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+#include <canvas/pathfinder.h>
+
+namespace cnv {
+
+// up, right, down, left
+static const int DX[4] = { 0, 1, 0, -1 };
+static const int DY[4] = { -1, 0, 1, 0 };
+
+static const uint32_t UNKNOWN = 0xFFFFFFFF;
+
+Pathfinder::Pathfinder(const GridMap& map) :
+	_map(map),
+	_width(map.width()),
+	_height(map.height()),
+	_trace(nullptr)
+{
+
+}
+
+Pathfinder::~Pathfinder()
+{
+
+}
+
+bool Pathfinder::solve(Algorithm algorithm, rt::vec2i start, rt::vec2i end, std::vector<rt::vec2i>& path)
+{
+	path.clear();
+	_stats = Stats();
+	if (!open(start.x, start.y) || !open(end.x, end.y)) {
+		return false;
+	}
+	// A* and JPS keep cells and costs in 32 bits (UNKNOWN included)
+	if ((algorithm == ASTAR || algorithm == JPS) && _map.size() >= UNKNOWN) {
+		return false;
+	}
+
+	auto begin = std::chrono::steady_clock::now();
+
+	size_t cells = _map.size();
+	_visited.assign((cells + 63) / 64, 0);
+	_from.resize(cells);
+	size_t s = _map.index(start.x, start.y);
+	size_t e = _map.index(end.x, end.y);
+
+	bool found = false;
+	switch (algorithm) {
+		case BFS: found = bfs(s, e, false); break;
+		case ASTAR: found = astar(s, e); break;
+		case JPS: found = jps(s, e); break;
+		case DEADEND: found = deadend(s, e); break;
+	}
+
+	if (found) {
+		if (algorithm == JPS) {
+			// straight lines between the jump points
+			size_t cell = e;
+			path.push_back(end);
+			while (cell != s) {
+				size_t parent = _parent[cell];
+				int x = cell % _width;
+				int y = cell / _width;
+				int px = parent % _width;
+				int py = parent / _width;
+				int dx = (px > x) - (px < x);
+				int dy = (py > y) - (py < y);
+				while (x != px || y != py) {
+					x += dx;
+					y += dy;
+					path.push_back(rt::vec2i(x, y));
+				}
+				cell = parent;
+			}
+			std::reverse(path.begin(), path.end());
+		} else {
+			backtrack(s, e, path);
+		}
+	}
+
+	auto done = std::chrono::steady_clock::now();
+	_stats.seconds = std::chrono::duration<double>(done - begin).count();
+	_stats.length = path.size();
+	return found;
+}
+
+void Pathfinder::backtrack(size_t start, size_t end, std::vector<rt::vec2i>& path) const
+{
+	size_t cell = end;
+	int x = end % _width;
+	int y = end / _width;
+	path.push_back(rt::vec2i(x, y));
+	while (cell != start) {
+		int d = _from[cell];
+		x -= DX[d];
+		y -= DY[d];
+		cell = _map.index(x, y);
+		path.push_back(rt::vec2i(x, y));
+	}
+	std::reverse(path.begin(), path.end());
+}
+
+bool Pathfinder::bfs(size_t start, size_t end, bool skipfilled)
+{
+	_queue.clear();
+	_queue.push_back(start);
+	visit(start);
+	for (size_t head = 0; head < _queue.size(); head++) {
+		size_t cell = _queue[head];
+		_stats.expanded++;
+		trace(cell);
+		if (cell == end) {
+			return true;
+		}
+
+		int x = cell % _width;
+		int y = cell / _width;
+		for (int d = 0; d < 4; d++) {
+			int nx = x + DX[d];
+			int ny = y + DY[d];
+			if (!open(nx, ny)) { continue; }
+			size_t next = _map.index(nx, ny);
+			if (visited(next) || (skipfilled && filled(next))) { continue; }
+			visit(next);
+			_from[next] = d;
+			_queue.push_back(next);
+		}
+	}
+	return false;
+}
+
+bool Pathfinder::astar(size_t start, size_t end)
+{
+	int ex = end % _width;
+	int ey = end / _width;
+	_cost.assign(_map.size(), UNKNOWN);
+	_heap.clear();
+	_cost[start] = 0;
+	_heap.push_back({ (uint32_t)(std::abs(ex - (int)(start % _width)) + std::abs(ey - (int)(start / _width))), 0, (uint32_t)start });
+
+	while (!_heap.empty()) {
+		std::pop_heap(_heap.begin(), _heap.end());
+		Node node = _heap.back();
+		_heap.pop_back();
+		if (visited(node.cell)) { continue; } // it was found cheaper already
+		visit(node.cell);
+		_stats.expanded++;
+		trace(node.cell);
+		if (node.cell == end) {
+			return true;
+		}
+
+		int x = node.cell % _width;
+		int y = node.cell / _width;
+		for (int d = 0; d < 4; d++) {
+			int nx = x + DX[d];
+			int ny = y + DY[d];
+			if (!open(nx, ny)) { continue; }
+			size_t next = _map.index(nx, ny);
+			uint32_t g = node.g + 1;
+			if (visited(next) || g >= _cost[next]) { continue; }
+			_cost[next] = g;
+			_from[next] = d;
+			_heap.push_back({ g + std::abs(ex - nx) + std::abs(ey - ny), g, (uint32_t)next });
+			std::push_heap(_heap.begin(), _heap.end());
+		}
+	}
+	return false;
+}
+
+long Pathfinder::jump(int x, int y, int dx, int dy, int ex, int ey) const
+{
+	while (true) {
+		x += dx;
+		y += dy;
+		if (!open(x, y)) {
+			return -1;
+		}
+		if (x == ex && y == ey) {
+			return _map.index(x, y);
+		}
+		if (dx != 0) {
+			// horizontal: stop where a vertical jump finds something
+			if (jump(x, y, 0, 1, ex, ey) >= 0 || jump(x, y, 0, -1, ex, ey) >= 0) {
+				return _map.index(x, y);
+			}
+		} else {
+			// vertical: stop at a forced neighbour, an opening left or right that wasn't there a step back
+			if ((open(x + 1, y) && !open(x + 1, y - dy)) || (open(x - 1, y) && !open(x - 1, y - dy))) {
+				return _map.index(x, y);
+			}
+		}
+	}
+}
+
+bool Pathfinder::jps(size_t start, size_t end)
+{
+	int ex = end % _width;
+	int ey = end / _width;
+	_cost.assign(_map.size(), UNKNOWN);
+	_parent.resize(_map.size());
+	_heap.clear();
+	_cost[start] = 0;
+	_parent[start] = start;
+	_heap.push_back({ (uint32_t)(std::abs(ex - (int)(start % _width)) + std::abs(ey - (int)(start / _width))), 0, (uint32_t)start });
+
+	while (!_heap.empty()) {
+		std::pop_heap(_heap.begin(), _heap.end());
+		Node node = _heap.back();
+		_heap.pop_back();
+		if (visited(node.cell)) { continue; }
+		visit(node.cell);
+		_stats.expanded++;
+		trace(node.cell);
+		if (node.cell == end) {
+			return true;
+		}
+
+		// the directions worth looking in, from the way we got here
+		int x = node.cell % _width;
+		int y = node.cell / _width;
+		int px = _parent[node.cell] % _width;
+		int py = _parent[node.cell] / _width;
+		int dx = (x > px) - (x < px);
+		int dy = (y > py) - (y < py);
+		int directions[4][2];
+		int count = 0;
+		if (node.cell == start) {
+			for (int d = 0; d < 4; d++) {
+				directions[count][0] = DX[d];
+				directions[count][1] = DY[d];
+				count++;
+			}
+		} else if (dx != 0) {
+			directions[count][0] = dx; directions[count][1] = 0; count++;
+			directions[count][0] = 0; directions[count][1] = 1; count++;
+			directions[count][0] = 0; directions[count][1] = -1; count++;
+		} else {
+			directions[count][0] = 0; directions[count][1] = dy; count++;
+			if (open(x + 1, y) && !open(x + 1, y - dy)) { directions[count][0] = 1; directions[count][1] = 0; count++; }
+			if (open(x - 1, y) && !open(x - 1, y - dy)) { directions[count][0] = -1; directions[count][1] = 0; count++; }
+		}
+
+		for (int i = 0; i < count; i++) {
+			long next = jump(x, y, directions[i][0], directions[i][1], ex, ey);
+			if (next < 0 || visited(next)) { continue; }
+			int nx = next % _width;
+			int ny = next / _width;
+			uint32_t g = node.g + std::abs(nx - x) + std::abs(ny - y);
+			if (g >= _cost[next]) { continue; }
+			_cost[next] = g;
+			_parent[next] = node.cell;
+			_heap.push_back({ g + std::abs(ex - nx) + std::abs(ey - ny), g, (uint32_t)next });
+			std::push_heap(_heap.begin(), _heap.end());
+		}
+	}
+	return false;
+}
+
+bool Pathfinder::deadend(size_t start, size_t end)
+{
+	_filled.assign((_map.size() + 63) / 64, 0);
+
+	// open cells that aren't the start or end, with one way in (or none)
+	auto deadend = [&](size_t cell) {
+		if (cell == start || cell == end || _map.wall(cell) || filled(cell)) {
+			return false;
+		}
+		int x = cell % _width;
+		int y = cell / _width;
+		int ways = 0;
+		for (int d = 0; d < 4; d++) {
+			int nx = x + DX[d];
+			int ny = y + DY[d];
+			if (open(nx, ny) && !filled(_map.index(nx, ny))) { ways++; }
+		}
+		return ways <= 1;
+	};
+
+	_queue.clear();
+	for (size_t cell = 0; cell < _map.size(); cell++) {
+		if (deadend(cell)) {
+			_queue.push_back(cell);
+		}
+	}
+
+	// fill them, and the ones that become dead ends
+	while (!_queue.empty()) {
+		size_t cell = _queue.back();
+		_queue.pop_back();
+		if (!deadend(cell)) { continue; }
+		_filled[cell / 64] |= (uint64_t)1 << (cell % 64);
+		_stats.expanded++;
+		trace(cell);
+
+		int x = cell % _width;
+		int y = cell / _width;
+		for (int d = 0; d < 4; d++) {
+			int nx = x + DX[d];
+			int ny = y + DY[d];
+			if (!open(nx, ny)) { continue; }
+			size_t next = _map.index(nx, ny);
+			if (deadend(next)) {
+				_queue.push_back(next);
+			}
+		}
+	}
+
+	// what's left are the paths (the only one, in a perfect maze)
+	return bfs(start, end, true);
+}
+
+} // namespace cnv
@@ -0,0 +1,100 @@
+/**
+ * @file pathfinder.h
+ * @brief cnv::Pathfinder header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef PATHFINDER_H
+#define PATHFINDER_H
+
+#include <cstdint>
+#include <vector>
+
+#include <pixelbuffer/pixelbuffer.h>
+
+#include <canvas/gridmap.h>
+
+namespace cnv {
+
+/// @brief Shortest paths on a GridMap, moving up, down, left and right.
+/// What an algorithm needs (a byte or a few per cell) is allocated when it first runs, and kept.
+class Pathfinder
+{
+public:
+	enum Algorithm
+	{
+		BFS, // breadth first, a bit per cell to know where we've been
+		ASTAR, // A*, a binary heap ordered by distance + manhattan distance to the end
+		JPS, // jump point search: A* that only stops where a path can turn
+		DEADEND // fill dead ends until only the paths are left, then BFS on those
+	};
+
+	/// @brief what the last solve() did
+	struct Stats
+	{
+		size_t expanded = 0; // cells (or jump points) taken from the queue, or filled
+		size_t length = 0; // cells in the path, start and end included. 0: no path
+		double seconds = 0.0;
+
+		/// @brief expansions per second
+		double rate() const { return seconds > 0.0 ? expanded / seconds : 0.0; }
+	};
+
+	/// @param map the grid, it's not copied
+	Pathfinder(const GridMap& map);
+	virtual ~Pathfinder();
+
+	/// @brief find a shortest path
+	/// @param algorithm how
+	/// @param start first cell
+	/// @param end last cell
+	/// @param path cleared, then the cells from start to end
+	/// @return there is a path. Always false for ASTAR and JPS on maps of 2^32 - 1 cells or more
+	bool solve(Algorithm algorithm, rt::vec2i start, rt::vec2i end, std::vector<rt::vec2i>& path);
+	const Stats& stats() const { return _stats; }
+
+	/// @brief keep the cells in the order they're expanded (or filled), for a replay
+	/// @param trace the cells (GridMap::index), or nullptr to stop tracing
+	void setTrace(std::vector<size_t>* trace) { _trace = trace; }
+
+private:
+	const GridMap& _map;
+	int _width;
+	int _height;
+	Stats _stats;
+	std::vector<size_t>* _trace;
+
+	std::vector<uint64_t> _visited; // or closed
+	std::vector<uint64_t> _filled; // dead ends
+	std::vector<uint8_t> _from; // direction we came from (BFS, A*)
+	std::vector<uint32_t> _cost; // from the start (A*, JPS)
+	std::vector<uint32_t> _parent; // jump point we came from (JPS)
+	std::vector<size_t> _queue;
+	struct Node
+	{
+		uint32_t f; // cost + heuristic
+		uint32_t g; // cost
+		uint32_t cell;
+		bool operator<(const Node& other) const { return f > other.f || (f == other.f && g < other.g); }
+	};
+	std::vector<Node> _heap;
+
+	bool visited(size_t i) const { return (_visited[i / 64] >> (i % 64)) & 1; }
+	void visit(size_t i) { _visited[i / 64] |= (uint64_t)1 << (i % 64); }
+	bool filled(size_t i) const { return (_filled[i / 64] >> (i % 64)) & 1; }
+	bool open(int x, int y) const { return !_map.wall(x, y); }
+	void trace(size_t i) { if (_trace != nullptr) { _trace->push_back(i); } }
+
+	bool bfs(size_t start, size_t end, bool skipfilled);
+	bool astar(size_t start, size_t end);
+	bool jps(size_t start, size_t end);
+	bool deadend(size_t start, size_t end);
+	/// @brief walk the _from directions back from the end
+	void backtrack(size_t start, size_t end, std::vector<rt::vec2i>& path) const;
+	/// @brief the next jump point from (x, y) in a direction, or -1
+	long jump(int x, int y, int dx, int dy, int ex, int ey) const;
+};
+
+} // namespace cnv
+
+#endif /* PATHFINDER_H */
@@ -9,6 +9,8 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <chrono>
+#include <cmath>
 
 #include <canvas/renderer.h>
 
@@ -22,14 +24,21 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
 
 namespace cnv {
 
-Renderer::Renderer(int w, int h) :
-	_window_width(w), _window_height(h), _window(nullptr)
+Renderer::Renderer(int w, int h, bool headless /* false */) :
+	_window_width(w), _window_height(h), _window(nullptr), _headless(headless), _programID(0)
 {
+	if (_headless) {
+		return; // no window, no GL
+	}
 	this->init();
 }
 
 Renderer::~Renderer()
 {
+	if (_headless) {
+		return;
+	}
+
 	// Cleanup VBO and shader
 	glDeleteProgram(_programID);
 
@@ -107,13 +116,15 @@ int Renderer::init()
 }
 
 float Renderer::updateDeltaTime() {
+	// steady_clock works without a window (glfwGetTime() needs glfwInit())
+	using clock = std::chrono::steady_clock;
 	// lastTime is initialised only the first time this function is called
-	static double lastTime = glfwGetTime();
+	static clock::time_point lastTime = clock::now();
 	// get the current time
-	double currentTime = glfwGetTime();
+	clock::time_point currentTime = clock::now();
 
 	// Compute time difference between current and last time
-	float deltaTime = float(currentTime - lastTime);
+	float deltaTime = std::chrono::duration<float>(currentTime - lastTime).count();
 
 	// For the next frame, the "last time" will be "now"
 	lastTime = currentTime;
@@ -122,16 +133,22 @@ float Renderer::updateDeltaTime() {
 
 void Renderer::hideMouse()
 {
+	if (_headless) { return; }
 	glfwSetInputMode(_window, GLFW_CURSOR, GLFW_CURSOR_HIDDEN);
 }
 
 void Renderer::showMouse()
 {
+	if (_headless) { return; }
 	glfwSetInputMode(_window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
 }
 
 bool Renderer::displayCanvas(Canvas* canvas, float px, float py, float sx, float sy, float rot)
 {
+	if (_headless) {
+		return false; // nothing to display on
+	}
+
 	// Clear the screen
 	glClear(GL_COLOR_BUFFER_BIT);
 
@@ -150,6 +167,26 @@ bool Renderer::displayCanvas(Canvas* canvas, float px, float py, float sx, float
 
 void Renderer::renderCanvas(Canvas* canvas, float px, float py, float sx, float sy, float rot)
 {
+	if (_headless) {
+		return;
+	}
+
+	// pixelbuffer to opengl texture, only the pixels that changed
+	// also regenerates mesh in case of pb->read("file.pbf");
+	if (!canvas->locked() || canvas->pending())
+	{
+		canvas->updateTexture();
+	}
+
+	drawCanvas(canvas, px, py, sx, sy, rot);
+}
+
+void Renderer::drawCanvas(Canvas* canvas, float px, float py, float sx, float sy, float rot)
+{
+	if (_headless || canvas->texture() == 0) {
+		return;
+	}
+
 	// Build the Model matrix
 	glm::mat4 translationMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(px, py, 0.0f));
 	glm::mat4 rotationMatrix    = glm::eulerAngleYXZ(0.0f, 0.0f, rot);
@@ -164,14 +201,6 @@ void Renderer::renderCanvas(Canvas* canvas, float px, float py, float sx, float
 	GLuint matrixID = glGetUniformLocation(_programID, "MVP");
 	glUniformMatrix4fv(matrixID, 1, GL_FALSE, &MVP[0][0]);
 
-	// pixelbuffer to opengl texture
-	// also regenerate mesh in case of pb->read("file.pbf");
-	if (!canvas->locked())
-	{
-		canvas->generateTexture();
-		canvas->generateGeometry(canvas->width(), canvas->height());
-	}
-
 	// Bind our texture in Texture Unit 0
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, canvas->texture());
@@ -212,6 +241,42 @@ void Renderer::renderCanvas(Canvas* canvas, float px, float py, float sx, float
 	glDisableVertexAttribArray(vertexUVID);
 }
 
+void Renderer::compositeCanvas(Canvas* canvas, rt::PixelBuffer& out, float px, float py, float sx, float sy)
+{
+	int cols = out.width();
+	int rows = out.height();
+	int cw = canvas->width();
+	int ch = canvas->height();
+	if (cols == 0 || rows == 0 || sx == 0.0f || sy == 0.0f) {
+		return;
+	}
+
+	// size of an output pixel in window coordinates
+	float wx = (float)_window_width / cols;
+	float wy = (float)_window_height / rows;
+
+	auto& src = canvas->pixelbuffer.pixels();
+	auto& dst = out.pixels();
+	for (int y = 0; y < rows; y++) {
+		// the canvas is centered on (px, py), same as the quad in renderCanvas()
+		int v = (int)std::floor(((y + 0.5f) * wy - py) / sy + ch / 2.0f);
+		if (v < 0 || v >= ch) { continue; }
+		for (int x = 0; x < cols; x++) {
+			int u = (int)std::floor(((x + 0.5f) * wx - px) / sx + cw / 2.0f);
+			if (u < 0 || u >= cw) { continue; }
+
+			// glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			const rt::RGBAColor& s = src[v * cw + u];
+			rt::RGBAColor& d = dst[y * cols + x];
+			int a = s.a;
+			d.r = (s.r * a + d.r * (255 - a)) / 255;
+			d.g = (s.g * a + d.g * (255 - a)) / 255;
+			d.b = (s.b * a + d.b * (255 - a)) / 255;
+			d.a = (s.a * a + d.a * (255 - a)) / 255;
+		}
+	}
+}
+
 GLuint Renderer::loadShaders()
 {
 	// Create the shaders
@@ -22,12 +22,18 @@ namespace cnv {
 class Renderer
 {
 public:
-	Renderer(int w, int h);
+	// a headless Renderer opens no window and has no OpenGL context
+	Renderer(int w, int h, bool headless = false);
 	virtual ~Renderer();
 
 	void renderCanvas(cnv::Canvas* canvas, float px, float py, float sx, float sy, float rot);
+	// same as renderCanvas, without uploading the pixelbuffer first
+	void drawCanvas(cnv::Canvas* canvas, float px, float py, float sx, float sy, float rot);
 	bool displayCanvas(cnv::Canvas* canvas, float px, float py, float sx, float sy, float rot);
+	// same as renderCanvas, but on the CPU into out (which covers the whole window), without rotation
+	void compositeCanvas(cnv::Canvas* canvas, rt::PixelBuffer& out, float px, float py, float sx, float sy);
 	GLFWwindow* window() { return _window; };
+	bool headless() { return _headless; };
 
 	int width() { return _window_width; };
 	int height() { return _window_height; };
@@ -43,6 +49,7 @@ private:
 	int _window_width;
 	int _window_height;
 	GLFWwindow* _window;
+	bool _headless;
 	
 	GLuint loadShaders();
 	GLuint _programID;
@@ -0,0 +1,87 @@
+/**
+ * @file spatialgrid.cpp
+ * @brief cnv::SpatialGrid implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <cmath>
+
+#include <canvas/spatialgrid.h>
+#include <canvas/parallel.h>
+
+namespace cnv {
+
+SpatialGrid::SpatialGrid(float width, float height, float cellsize) :
+	_width(width),
+	_height(height),
+	_cellsize(cellsize)
+{
+	_cols = std::max(1, (int)std::ceil(width / cellsize));
+	_rows = std::max(1, (int)std::ceil(height / cellsize));
+	_cells = std::vector<uint32_t>(_cols * _rows + 1, 0);
+}
+
+SpatialGrid::~SpatialGrid()
+{
+
+}
+
+void SpatialGrid::build(const float* x, const float* y, size_t count)
+{
+	_cellof.resize(count);
+	_indices.resize(count);
+	_x.resize(count);
+	_y.resize(count);
+
+	// count the points per cell
+	std::fill(_cells.begin(), _cells.end(), 0);
+	for (size_t i = 0; i < count; i++) {
+		uint32_t c = cell(y[i], _rows) * _cols + cell(x[i], _cols);
+		_cellof[i] = c;
+		_cells[c + 1]++;
+	}
+	for (size_t c = 1; c < _cells.size(); c++) {
+		_cells[c] += _cells[c - 1];
+	}
+
+	// and put them in place. _cells[c] moves on to the end of cell c, the start of cell c+1...
+	for (size_t i = 0; i < count; i++) {
+		uint32_t k = _cells[_cellof[i]]++;
+		_indices[k] = i;
+		_x[k] = x[i];
+		_y[k] = y[i];
+	}
+	// ...so shift it back
+	for (size_t c = _cells.size() - 1; c > 0; c--) {
+		_cells[c] = _cells[c - 1];
+	}
+	_cells[0] = 0;
+}
+
+void SpatialGrid::neighbours(float px, float py, float radius, std::vector<uint32_t>& out) const
+{
+	out.clear();
+	query(px, py, radius, [&](uint32_t index) {
+		out.push_back(index);
+	});
+}
+
+void SpatialGrid::queryAll(float radius, const std::function<void(uint32_t index, const uint32_t* neighbours, size_t count)>& fn) const
+{
+	// in grid order: the neighbours of one point are the neighbours of the next
+	parallel_for(_indices.size(), [&](size_t begin, size_t end) {
+		std::vector<uint32_t> found;
+		for (size_t k = begin; k < end; k++) {
+			uint32_t index = _indices[k];
+			found.clear();
+			query(_x[k], _y[k], radius, [&](uint32_t other) {
+				if (other != index) {
+					found.push_back(other);
+				}
+			});
+			fn(index, found.data(), found.size());
+		}
+	});
+}
+
+} // namespace cnv
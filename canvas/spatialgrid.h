@@ -0,0 +1,89 @@
+/**
+ * @file spatialgrid.h
+ * @brief cnv::SpatialGrid header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace cnv {
+
+/// @brief A uniform grid of points, to find the points near a point.
+/// build() counting-sorts the points by cell, and copies their positions in that order, so the
+/// points of a cell are next to each other in memory. Nothing is allocated once it has seen the most points.
+class SpatialGrid
+{
+public:
+	/// @brief an empty grid
+	/// @param width width of the area (points outside of it go into the cells at the edge)
+	/// @param height height of the area
+	/// @param cellsize size of a cell, about the radius of the queries
+	SpatialGrid(float width, float height, float cellsize);
+	virtual ~SpatialGrid();
+
+	int cols() const { return _cols; }
+	int rows() const { return _rows; }
+	size_t size() const { return _indices.size(); }
+
+	/// @brief sort the points into the grid
+	/// @param x x of every point
+	/// @param y y of every point
+	/// @param count number of points
+	void build(const float* x, const float* y, size_t count);
+
+	/// @brief call fn(index) for every point within radius of (px, py), the point itself included
+	template <typename F>
+	void query(float px, float py, float radius, F fn) const
+	{
+		int left = cell(px - radius, _cols);
+		int right = cell(px + radius, _cols);
+		int top = cell(py - radius, _rows);
+		int bottom = cell(py + radius, _rows);
+		float r2 = radius * radius;
+		for (int cy = top; cy <= bottom; cy++) {
+			for (int cx = left; cx <= right; cx++) {
+				int c = cy * _cols + cx;
+				for (uint32_t k = _cells[c]; k < _cells[c + 1]; k++) {
+					float dx = _x[k] - px;
+					float dy = _y[k] - py;
+					if (dx * dx + dy * dy <= r2) {
+						fn(_indices[k]);
+					}
+				}
+			}
+		}
+	}
+
+	/// @brief the points within radius of (px, py)
+	/// @param out cleared, then the indices
+	void neighbours(float px, float py, float radius, std::vector<uint32_t>& out) const;
+
+	/// @brief for every point, in bands on the ThreadPool: fn(index, its neighbours within radius (not itself), number of neighbours)
+	/// fn can write to anything of its own point, but only read the others.
+	void queryAll(float radius, const std::function<void(uint32_t index, const uint32_t* neighbours, size_t count)>& fn) const;
+
+private:
+	float _width;
+	float _height;
+	float _cellsize;
+	int _cols;
+	int _rows;
+
+	std::vector<uint32_t> _cells; // points of cell c: _cells[c] .. _cells[c+1]
+	std::vector<uint32_t> _indices; // the points, by cell
+	std::vector<float> _x; // their positions, by cell
+	std::vector<float> _y;
+	std::vector<uint32_t> _cellof; // cell of every point, while building
+
+	int cell(float v, int cells) const { return std::min(std::max((int)(v / _cellsize), 0), cells - 1); }
+};
+
+} // namespace cnv
+
+#endif /* SPATIALGRID_H */
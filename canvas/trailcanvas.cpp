@@ -0,0 +1,162 @@
+/**
+ * @file trailcanvas.cpp
+ * @brief cnv::TrailCanvas implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <canvas/trailcanvas.h>
+#include <canvas/parallel.h>
+
+namespace cnv {
+
+TrailCanvas::TrailCanvas(uint16_t width, uint16_t height, uint8_t bitdepth, uint8_t scale) :
+	Canvas(width, height, bitdepth, scale),
+	_cols(width),
+	_rows(height),
+	_exposure(1.0f),
+	_tonemap(CLAMP)
+{
+	_light = std::vector<float>(_cols * _rows * 3, 0.0f);
+	pixelbuffer.fill(BLACK);
+}
+
+TrailCanvas::~TrailCanvas()
+{
+
+}
+
+void TrailCanvas::add(int x, int y, const rt::RGBAColor& color, float intensity)
+{
+	if (x < 0 || y < 0 || x >= _cols || y >= _rows) {
+		return;
+	}
+	float* light = &_light[(y * _cols + x) * 3];
+	intensity /= 255.0f;
+	light[0] += color.r * intensity;
+	light[1] += color.g * intensity;
+	light[2] += color.b * intensity;
+}
+
+void TrailCanvas::splat(float x, float y, const rt::RGBAColor& color, float intensity)
+{
+	// the pixel to the top left of the position, and how far we are towards the next one
+	float fx = x - 0.5f;
+	float fy = y - 0.5f;
+	float left = std::floor(fx);
+	float top = std::floor(fy);
+	float tx = fx - left;
+	float ty = fy - top;
+	int px = left;
+	int py = top;
+
+	float r = color.r * intensity / 255.0f;
+	float g = color.g * intensity / 255.0f;
+	float b = color.b * intensity / 255.0f;
+	if (px >= 0 && py >= 0 && px + 1 < _cols && py + 1 < _rows) {
+		// inside: two pixels in this row, two in the next
+		float weights[4] = { (1.0f - tx) * (1.0f - ty), tx * (1.0f - ty), (1.0f - tx) * ty, tx * ty };
+		float* rows[2] = { &_light[(py * _cols + px) * 3], &_light[((py + 1) * _cols + px) * 3] };
+		for (int i = 0; i < 4; i++) {
+			float* light = rows[i / 2] + (i % 2) * 3;
+			light[0] += r * weights[i];
+			light[1] += g * weights[i];
+			light[2] += b * weights[i];
+		}
+		return;
+	}
+
+	add(px,     py,     color, intensity * (1.0f - tx) * (1.0f - ty));
+	add(px + 1, py,     color, intensity * tx * (1.0f - ty));
+	add(px,     py + 1, color, intensity * (1.0f - tx) * ty);
+	add(px + 1, py + 1, color, intensity * tx * ty);
+}
+
+void TrailCanvas::decay(float factor)
+{
+	float* light = _light.data();
+	parallel_for(_light.size(), [light, factor](size_t begin, size_t end) {
+		size_t i = begin;
+#ifdef __SSE2__
+		const __m128 vfactor = _mm_set1_ps(factor);
+		for (; i + 4 <= end; i += 4) {
+			_mm_storeu_ps(&light[i], _mm_mul_ps(_mm_loadu_ps(&light[i]), vfactor));
+		}
+#endif
+		for (; i < end; i++) {
+			light[i] *= factor;
+		}
+	}, 65536);
+}
+
+void TrailCanvas::clear()
+{
+	std::fill(_light.begin(), _light.end(), 0.0f);
+}
+
+void TrailCanvas::resolve()
+{
+	if (pixelbuffer.width() != _cols || pixelbuffer.height() != _rows) {
+		return;
+	}
+
+	std::vector<rt::RGBAColor>& pixels = pixelbuffer.pixels();
+	const float exposure = _exposure;
+	const bool soft = _tonemap == SOFT;
+	parallel_for_rows(_rows, [&](const RowBand& band) {
+		for (size_t y = band.begin; y < band.end; y++) {
+			const float* light = &_light[y * _cols * 3];
+			rt::RGBAColor* row = &pixels[y * _cols];
+			int x = 0;
+#ifdef __SSE2__
+			// 4 pixels (12 floats) at a time, to 12 bytes
+			if (_palette.empty()) {
+				const __m128 vexposure = _mm_set1_ps(exposure);
+				const __m128 zero = _mm_setzero_ps();
+				const __m128 one = _mm_set1_ps(1.0f);
+				const __m128 full = _mm_set1_ps(255.0f);
+				alignas(16) uint8_t bytes[16];
+				for (; x + 4 <= _cols; x += 4) {
+					__m128i c[3];
+					for (int i = 0; i < 3; i++) {
+						__m128 v = _mm_max_ps(_mm_mul_ps(_mm_loadu_ps(&light[x * 3 + i * 4]), vexposure), zero);
+						if (soft) {
+							v = _mm_div_ps(v, _mm_add_ps(one, v));
+						}
+						c[i] = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(v, one), full));
+					}
+					__m128i words = _mm_packs_epi32(c[0], c[1]);
+					_mm_store_si128((__m128i*)bytes, _mm_packus_epi16(words, _mm_packs_epi32(c[2], c[2])));
+					for (int p = 0; p < 4; p++) {
+						row[x + p] = rt::RGBAColor(bytes[p * 3], bytes[p * 3 + 1], bytes[p * 3 + 2], 255);
+					}
+				}
+			}
+#endif
+			for (; x < _cols; x++) {
+				float c[3];
+				for (int i = 0; i < 3; i++) {
+					float v = std::max(light[x * 3 + i] * exposure, 0.0f);
+					if (soft) {
+						v = v / (1.0f + v);
+					}
+					c[i] = std::min(v, 1.0f) * 255.0f + 0.5f;
+				}
+				if (_palette.empty()) {
+					row[x] = rt::RGBAColor(c[0], c[1], c[2], 255);
+				} else {
+					float brightest = std::max(c[0], std::max(c[1], c[2]));
+					row[x] = _palette[(size_t)brightest * _palette.size() / 256];
+				}
+			}
+		}
+	}, _cols * 3 * sizeof(float));
+}
+
+} // namespace cnv
@@ -0,0 +1,67 @@
+/**
+ * @file trailcanvas.h
+ * @brief cnv::TrailCanvas header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef TRAILCANVAS_H
+#define TRAILCANVAS_H
+
+#include <vector>
+
+#include <canvas/canvas.h>
+
+namespace cnv {
+
+/// @brief A Canvas that keeps trails: light is added to a float buffer and fades out with decay().
+/// The buffer is tone-mapped into the pixelbuffer only when the Canvas is uploaded (resolve()),
+/// instead of blurring the pixelbuffer every update.
+class TrailCanvas : public Canvas
+{
+public:
+	/// @brief how the light is mapped to pixels
+	enum ToneMap
+	{
+		CLAMP, // light above 1.0 is white
+		SOFT // light / (1 + light), never quite white
+	};
+
+	TrailCanvas(uint16_t width, uint16_t height, uint8_t bitdepth = 32, uint8_t scale = 1);
+	virtual ~TrailCanvas();
+
+	/// @brief add light at a sub-pixel position, spread over the 4 nearest pixels
+	/// @param x horizontal position, pixel centers are at .5
+	/// @param y vertical position, pixel centers are at .5
+	/// @param color the color of the light
+	/// @param intensity 1.0 adds the color once
+	void splat(float x, float y, const rt::RGBAColor& color, float intensity = 1.0f);
+	/// @brief add light to a single pixel
+	void add(int x, int y, const rt::RGBAColor& color, float intensity = 1.0f);
+	/// @brief fade all light out
+	/// @param factor light is multiplied by this (0.0 - 1.0)
+	void decay(float factor);
+	/// @brief no light at all
+	void clear();
+
+	/// @brief light is multiplied by this before mapping it
+	void setExposure(float exposure) { _exposure = exposure; }
+	void setToneMap(ToneMap tonemap) { _tonemap = tonemap; }
+	/// @brief color the pixels by their brightness (the brightest channel after the tone map)
+	/// @param palette dark to bright, 256 colors is plenty. Empty for the color of the light itself
+	void setPalette(const std::vector<rt::RGBAColor>& palette) { _palette = palette; }
+
+	/// @brief tone-map the light into the pixelbuffer
+	void resolve() override;
+
+private:
+	std::vector<float> _light; // r, g, b per pixel
+	int _cols;
+	int _rows;
+	float _exposure;
+	ToneMap _tonemap;
+	std::vector<rt::RGBAColor> _palette;
+};
+
+} // namespace cnv
+
+#endif /* TRAILCANVAS_H */
@@ -0,0 +1,50 @@
+/**
+ * @file triplebuffer.cpp
+ * @brief cnv::TripleBuffer implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <canvas/triplebuffer.h>
+
+namespace cnv {
+
+TripleBuffer::TripleBuffer() : _back(0), _front(1), _middle(2)
+{
+
+}
+
+TripleBuffer::~TripleBuffer()
+{
+
+}
+
+void TripleBuffer::publish()
+{
+	// our back becomes the middle, the old middle is our new back
+	int middle = _middle.exchange(_back | FRESH, std::memory_order_acq_rel);
+	_back = middle & ~FRESH;
+}
+
+void TripleBuffer::write(rt::PixelBuffer& pixelbuffer, const rt::vec2i& position, uint8_t scale)
+{
+	Frame& frame = back();
+	frame.pixels = pixelbuffer.pixels(); // reuses the capacity of the vector
+	frame.width = pixelbuffer.width();
+	frame.height = pixelbuffer.height();
+	frame.position = position;
+	frame.scale = scale;
+	publish();
+}
+
+bool TripleBuffer::acquire()
+{
+	if ((_middle.load(std::memory_order_acquire) & FRESH) == 0) {
+		return false;
+	}
+	// our front becomes the middle, the (fresh) middle is our new front
+	int middle = _middle.exchange(_front, std::memory_order_acq_rel);
+	_front = middle & ~FRESH;
+	return true;
+}
+
+} // namespace cnv
@@ -0,0 +1,59 @@
+/**
+ * @file triplebuffer.h
+ * @brief cnv::TripleBuffer header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+#include <vector>
+
+#include <pixelbuffer/pixelbuffer.h>
+
+namespace cnv {
+
+/// @brief Hands pixels from one writing thread to one reading thread without locks.
+/// The writer always has a buffer to write to, the reader always gets the newest complete one.
+class TripleBuffer
+{
+public:
+	/// @brief a copy of a layer
+	struct Frame
+	{
+		std::vector<rt::RGBAColor> pixels;
+		int width = 0;
+		int height = 0;
+		rt::vec2i position;
+		uint8_t scale = 1;
+	};
+
+	TripleBuffer();
+	virtual ~TripleBuffer();
+
+	/// @brief writer: the buffer to fill
+	Frame& back() { return _frames[_back]; }
+	/// @brief writer: make back() available to the reader, and get a new back()
+	void publish();
+	/// @brief writer: copy the pixelbuffer into back() and publish() it
+	void write(rt::PixelBuffer& pixelbuffer, const rt::vec2i& position, uint8_t scale);
+
+	/// @brief reader: swap in the newest published buffer
+	/// @return false if nothing was published since the last call
+	bool acquire();
+	/// @brief reader: the newest buffer since acquire()
+	Frame& front() { return _frames[_front]; }
+
+private:
+	Frame _frames[3];
+	int _back;
+	int _front;
+	// index of the middle buffer, with FRESH set if the writer published it after the last acquire()
+	std::atomic<int> _middle;
+	static const int FRESH = 4;
+};
+
+} // namespace cnv
+
+#endif /* TRIPLEBUFFER_H */
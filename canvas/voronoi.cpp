@@ -0,0 +1,263 @@
+/**
+ * @file voronoi.cpp
+ * @brief cnv::VoronoiEngine implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+#include <canvas/voronoi.h>
+#include <canvas/parallel.h>
+
+namespace cnv {
+
+VoronoiEngine::VoronoiEngine(int width, int height) :
+	_width(width),
+	_height(height),
+	_cellsize(1),
+	_columns(1),
+	_rows(1),
+	_moved(0.0),
+	_valid(false)
+{
+	_owners = std::vector<int32_t>(width * height, -1);
+	_scratch = std::vector<int32_t>(width * height, -1);
+	_budget = std::vector<float>(width * height, 0.0f);
+}
+
+VoronoiEngine::~VoronoiEngine()
+{
+
+}
+
+void VoronoiEngine::setSeeds(const std::vector<rt::vec2i>& seeds)
+{
+	_seeds = seeds;
+}
+
+void VoronoiEngine::bucketize()
+{
+	// about 2 seeds per bucket
+	size_t count = std::max((size_t)1, _seeds.size());
+	_cellsize = std::max(1, (int)std::sqrt(2.0 * _width * _height / count));
+	_columns = (_width + _cellsize - 1) / _cellsize;
+	_rows = (_height + _cellsize - 1) / _cellsize;
+
+	// counting sort. Seeds outside of the field go into the bucket at the edge
+	std::vector<uint32_t> bucketof(_seeds.size());
+	_buckets.assign(_columns * _rows + 1, 0);
+	for (size_t i = 0; i < _seeds.size(); i++) {
+		int bx = std::min(std::max(_seeds[i].x / _cellsize, 0), _columns - 1);
+		int by = std::min(std::max(_seeds[i].y / _cellsize, 0), _rows - 1);
+		bucketof[i] = by * _columns + bx;
+		_buckets[bucketof[i] + 1]++;
+	}
+	for (size_t b = 1; b < _buckets.size(); b++) {
+		_buckets[b] += _buckets[b - 1];
+	}
+	_bucketseeds.resize(_seeds.size());
+	std::vector<uint32_t> fill(_buckets.begin(), _buckets.end() - 1);
+	for (size_t i = 0; i < _seeds.size(); i++) {
+		_bucketseeds[fill[bucketof[i]]++] = i;
+	}
+}
+
+int32_t VoronoiEngine::nearest(int x, int y, float& margin) const
+{
+	const int64_t none = std::numeric_limits<int64_t>::max();
+	int64_t best = none;
+	int64_t second = none;
+	int32_t owner = -1;
+
+	auto visit = [&](int bx, int by) {
+		int b = by * _columns + bx;
+		for (uint32_t s = _buckets[b]; s < _buckets[b + 1]; s++) {
+			int32_t i = _bucketseeds[s];
+			int64_t dx = _seeds[i].x - x;
+			int64_t dy = _seeds[i].y - y;
+			int64_t d = dx * dx + dy * dy;
+			if (d < best || (d == best && i < owner)) {
+				second = best;
+				best = d;
+				owner = i;
+			} else if (d < second) {
+				second = d;
+			}
+		}
+	};
+
+	// rings of buckets around the cell, until the next ring can't be any closer than the second nearest
+	int cx = x / _cellsize;
+	int cy = y / _cellsize;
+	int rings = std::max(_columns, _rows);
+	for (int r = 0; r <= rings; r++) {
+		int left = cx - r;
+		int right = cx + r;
+		int top = cy - r;
+		int bottom = cy + r;
+		for (int bx = std::max(left, 0); bx <= std::min(right, _columns - 1); bx++) {
+			if (top >= 0) { visit(bx, top); }
+			if (bottom < _rows && r > 0) { visit(bx, bottom); }
+		}
+		for (int by = std::max(top + 1, 0); by <= std::min(bottom - 1, _rows - 1); by++) {
+			if (left >= 0 && r > 0) { visit(left, by); }
+			if (right < _columns && r > 0) { visit(right, by); }
+		}
+
+		// a seed in the next ring is at least this far away
+		int64_t bound = (int64_t)r * _cellsize + 1;
+		if (second < bound * bound) {
+			break;
+		}
+	}
+
+	if (second == none) {
+		margin = std::numeric_limits<float>::infinity();
+	} else {
+		margin = std::sqrt((double)second) - std::sqrt((double)best);
+	}
+	return owner;
+}
+
+void VoronoiEngine::compute()
+{
+	bucketize();
+	_moved = 0.0;
+
+	parallel_for_rows(_height, [&](const RowBand& band) {
+		for (size_t y = band.begin; y < band.end; y++) {
+			for (int x = 0; x < _width; x++) {
+				size_t i = y * _width + x;
+				float margin;
+				_owners[i] = nearest(x, y, margin);
+				_budget[i] = margin - 0.01f;
+			}
+		}
+	});
+
+	_previous = _seeds;
+	_valid = true;
+}
+
+size_t VoronoiEngine::update()
+{
+	// start over when the seeds were added or removed, or when _moved gets too big for a float
+	if (!_valid || _seeds.size() != _previous.size() || _moved > 4096.0) {
+		compute();
+		return _owners.size();
+	}
+
+	// no distance changed more than the furthest move
+	double furthest = 0.0;
+	for (size_t i = 0; i < _seeds.size(); i++) {
+		rt::vec2i delta = _seeds[i] - _previous[i];
+		furthest = std::max(furthest, std::sqrt((double)delta.x * delta.x + (double)delta.y * delta.y));
+	}
+	if (furthest == 0.0) {
+		return 0;
+	}
+	_previous = _seeds;
+
+	// so no margin between the nearest and the next nearest shrunk more than twice that
+	bucketize();
+	_moved += 2.0 * furthest;
+	float moved = _moved;
+
+	std::atomic<size_t> count(0);
+	parallel_for_rows(_height, [&](const RowBand& band) {
+		size_t done = 0;
+		for (size_t y = band.begin; y < band.end; y++) {
+			for (int x = 0; x < _width; x++) {
+				size_t i = y * _width + x;
+				if (moved >= _budget[i]) {
+					float margin;
+					_owners[i] = nearest(x, y, margin);
+					_budget[i] = (float)(_moved + margin) - 0.01f;
+					done++;
+				}
+			}
+		}
+		count += done;
+	});
+
+	return count;
+}
+
+void VoronoiEngine::flood(int step)
+{
+	parallel_for_rows(_height, [&](const RowBand& band) {
+		for (size_t y = band.begin; y < band.end; y++) {
+			for (int x = 0; x < _width; x++) {
+				int32_t owner = _owners[y * _width + x];
+				int64_t best = std::numeric_limits<int64_t>::max();
+				if (owner >= 0) {
+					int64_t dx = _seeds[owner].x - x;
+					int64_t dy = _seeds[owner].y - y;
+					best = dx * dx + dy * dy;
+				}
+				// the nearest seed of the 8 cells step away may be nearer
+				for (int ny = (int)y - step; ny <= (int)y + step; ny += step) {
+					if (ny < 0 || ny >= _height) { continue; }
+					for (int nx = x - step; nx <= x + step; nx += step) {
+						if (nx < 0 || nx >= _width) { continue; }
+						int32_t other = _owners[ny * _width + nx];
+						if (other < 0 || other == owner) { continue; }
+						int64_t dx = _seeds[other].x - x;
+						int64_t dy = _seeds[other].y - y;
+						int64_t d = dx * dx + dy * dy;
+						if (d < best || (d == best && other < owner)) {
+							best = d;
+							owner = other;
+						}
+					}
+				}
+				_scratch[y * _width + x] = owner;
+			}
+		}
+	});
+	_owners.swap(_scratch);
+}
+
+void VoronoiEngine::jumpFlood()
+{
+	std::fill(_owners.begin(), _owners.end(), -1);
+	for (size_t i = 0; i < _seeds.size(); i++) {
+		int x = _seeds[i].x;
+		int y = _seeds[i].y;
+		if (x >= 0 && x < _width && y >= 0 && y < _height && _owners[y * _width + x] < 0) {
+			_owners[y * _width + x] = i;
+		}
+	}
+
+	int step = 1;
+	while (step * 2 < std::max(_width, _height)) {
+		step *= 2;
+	}
+	for (; step >= 1; step /= 2) {
+		flood(step);
+	}
+	// one more, fixes most of the mistakes
+	flood(1);
+
+	_valid = false;
+}
+
+void VoronoiEngine::render(rt::PixelBuffer& pixelbuffer, const std::vector<rt::RGBAColor>& colors) const
+{
+	if (pixelbuffer.width() != _width || pixelbuffer.height() != _height) {
+		return;
+	}
+
+	std::vector<rt::RGBAColor>& pixels = pixelbuffer.pixels();
+	parallel_for_rows(_height, [&](const RowBand& band) {
+		for (size_t i = band.begin * _width; i < band.end * _width; i++) {
+			int32_t owner = _owners[i];
+			pixels[i] = (owner >= 0 && (size_t)owner < colors.size()) ? colors[owner] : rt::RGBAColor(0, 0, 0, 255);
+		}
+	});
+}
+
+} // namespace cnv
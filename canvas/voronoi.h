@@ -0,0 +1,88 @@
+/**
+ * @file voronoi.h
+ * @brief cnv::VoronoiEngine header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef VORONOI_H
+#define VORONOI_H
+
+#include <cstdint>
+#include <vector>
+
+#include <pixelbuffer/pixelbuffer.h>
+
+namespace cnv {
+
+/// @brief Finds the nearest seed for every cell of a field (a Voronoi diagram).
+/// Distances are squared integers, a tie goes to the seed with the lowest index. Seeds are counting-sorted
+/// into a grid of buckets, so a cell only looks at the seeds in the buckets around it.
+/// All passes run in bands of rows on the ThreadPool.
+class VoronoiEngine
+{
+public:
+	/// @brief no seeds yet
+	/// @param width width
+	/// @param height height
+	VoronoiEngine(int width, int height);
+	virtual ~VoronoiEngine();
+
+	int width() const { return _width; }
+	int height() const { return _height; }
+	size_t seeds() const { return _seeds.size(); }
+
+	/// @brief set the positions of the seeds (they can be outside of the field)
+	/// @param seeds the positions
+	void setSeeds(const std::vector<rt::vec2i>& seeds);
+
+	/// @brief exact nearest seed for every cell
+	void compute();
+	/// @brief exact nearest seed, but only for the cells where a seed that moved since the last
+	/// compute() or update() can have taken over (near the edges of the regions). Much less work than
+	/// compute() when seeds move a little at a time.
+	/// @return number of cells done again
+	size_t update();
+	/// @brief approximate nearest seed for every cell (jump flooding, log2(size) passes over the field,
+	/// however many seeds there are). Seeds outside of the field are left out.
+	void jumpFlood();
+
+	/// @brief index of the nearest seed, -1 when there are none
+	int owner(int x, int y) const { return _owners[y * _width + x]; }
+	/// @brief the nearest seed of every cell, row by row
+	const std::vector<int32_t>& owners() const { return _owners; }
+
+	/// @brief write the color of the nearest seed into a pixelbuffer of the same size
+	/// @param pixelbuffer the pixelbuffer
+	/// @param colors a color for every seed
+	void render(rt::PixelBuffer& pixelbuffer, const std::vector<rt::RGBAColor>& colors) const;
+
+private:
+	int _width;
+	int _height;
+	std::vector<rt::vec2i> _seeds;
+	std::vector<rt::vec2i> _previous; // seeds at the last compute() or update()
+
+	// buckets of seeds, _bucketseeds[_buckets[b] .. _buckets[b+1]]
+	int _cellsize;
+	int _columns;
+	int _rows;
+	std::vector<uint32_t> _buckets;
+	std::vector<uint32_t> _bucketseeds;
+
+	std::vector<int32_t> _owners;
+	std::vector<int32_t> _scratch;
+
+	// a cell is done again once the seeds have moved _budget[cell] in total:
+	// the distance to the next nearest seed minus the distance to the nearest, at the time
+	std::vector<float> _budget;
+	double _moved; // in total, since _budget was filled
+	bool _valid; // _owners and _budget are exact
+
+	void bucketize();
+	int32_t nearest(int x, int y, float& margin) const;
+	void flood(int step);
+};
+
+} // namespace cnv
+
+#endif /* VORONOI_H */
@@ -0,0 +1,190 @@
+/**
+ * @file wireworld.cpp
+ * @brief cnv::WireWorld implementation
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#include <canvas/wireworld.h>
+
+namespace cnv {
+
+WireWorld::WireWorld(int width, int height) :
+	_width(width),
+	_height(height),
+	_generation(0),
+	_compiled(false)
+{
+	_grid = std::vector<uint8_t>(width * height, EMPTY);
+	_ids = std::vector<int32_t>(width * height, -1);
+}
+
+WireWorld::~WireWorld()
+{
+
+}
+
+WireWorld::State WireWorld::getCell(int x, int y) const
+{
+	rt::vec2i p = rt::wrap(rt::vec2i(x, y), _width, _height);
+	size_t index = rt::index(p.x, p.y, _width);
+	int32_t id = _ids[index];
+	return (State)(id >= 0 ? _states[id] : _grid[index]);
+}
+
+void WireWorld::setCell(int x, int y, State state)
+{
+	rt::vec2i p = rt::wrap(rt::vec2i(x, y), _width, _height);
+	size_t index = rt::index(p.x, p.y, _width);
+	_grid[index] = state;
+	int32_t id = _ids[index];
+	if (id >= 0) {
+		_states[id] = state;
+	}
+	_compiled = false;
+}
+
+void WireWorld::compile()
+{
+	// the current state of every cell
+	for (size_t i = 0; i < _cells.size(); i++) {
+		_grid[_cells[i]] = _states[i];
+	}
+
+	// a node for every cell that isn't EMPTY
+	_cells.clear();
+	_states.clear();
+	std::fill(_ids.begin(), _ids.end(), -1);
+	for (size_t i = 0; i < _grid.size(); i++) {
+		if (_grid[i] != EMPTY) {
+			_ids[i] = _cells.size();
+			_cells.push_back(i);
+			_states.push_back(_grid[i]);
+		}
+	}
+
+	// and its neighbours (wrapped), that aren't EMPTY either
+	_offsets.clear();
+	_neighbours.clear();
+	for (size_t i = 0; i < _cells.size(); i++) {
+		_offsets.push_back(_neighbours.size());
+		int x = _cells[i] % _width;
+		int y = _cells[i] / _width;
+		for (int r = -1; r < 2; r++) {
+			for (int c = -1; c < 2; c++) {
+				if (r == 0 && c == 0) {
+					continue; // this is us
+				}
+				rt::vec2i n = rt::wrap(rt::vec2i(x + c, y + r), _width, _height);
+				int32_t id = _ids[rt::index(n.x, n.y, _width)];
+				if (id >= 0) {
+					_neighbours.push_back(id);
+				}
+			}
+		}
+	}
+	_offsets.push_back(_neighbours.size());
+
+	_heads.clear();
+	_tails.clear();
+	for (size_t i = 0; i < _cells.size(); i++) {
+		if (_states[i] == HEAD) { _heads.push_back(i); }
+		if (_states[i] == TAIL) { _tails.push_back(i); }
+	}
+	_counts = std::vector<uint8_t>(_cells.size(), 0);
+
+	// draw everything next time
+	_changed.clear();
+	_ischanged = std::vector<uint8_t>(_cells.size(), 0);
+	for (size_t i = 0; i < _cells.size(); i++) {
+		changed(i);
+	}
+
+	_generation = 0;
+	_compiled = true;
+}
+
+void WireWorld::changed(uint32_t node)
+{
+	if (!_ischanged[node]) {
+		_ischanged[node] = 1;
+		_changed.push_back(node);
+	}
+}
+
+void WireWorld::step(int generations)
+{
+	if (!_compiled) {
+		compile();
+	}
+
+	for (int g = 0; g < generations; g++) {
+		// CONDUCTOR: if 1 or 2 neighbours are HEAD -> HEAD
+		_counted.clear();
+		for (uint32_t head : _heads) {
+			for (uint32_t i = _offsets[head]; i < _offsets[head + 1]; i++) {
+				uint32_t n = _neighbours[i];
+				if (_states[n] == CONDUCTOR) {
+					if (_counts[n] == 0) { _counted.push_back(n); }
+					_counts[n]++;
+				}
+			}
+		}
+		_next.clear();
+		for (uint32_t n : _counted) {
+			if (_counts[n] <= 2) { _next.push_back(n); }
+			_counts[n] = 0;
+		}
+
+		// TAIL -> CONDUCTOR
+		for (uint32_t tail : _tails) {
+			_states[tail] = CONDUCTOR;
+			changed(tail);
+		}
+		// HEAD -> TAIL
+		for (uint32_t head : _heads) {
+			_states[head] = TAIL;
+			changed(head);
+		}
+		for (uint32_t head : _next) {
+			_states[head] = HEAD;
+			changed(head);
+		}
+
+		// the heads become the tails, and the new heads the heads
+		_tails.swap(_heads);
+		_heads.swap(_next);
+		_generation++;
+	}
+}
+
+void WireWorld::render(rt::PixelBuffer& pixelbuffer, const rt::RGBAColor palette[4])
+{
+	if (pixelbuffer.width() != _width || pixelbuffer.height() != _height) {
+		return;
+	}
+	std::vector<rt::RGBAColor>& pixels = pixelbuffer.pixels();
+	for (size_t i = 0; i < _cells.size(); i++) {
+		pixels[_cells[i]] = palette[_states[i]];
+	}
+	for (uint32_t node : _changed) {
+		_ischanged[node] = 0;
+	}
+	_changed.clear();
+}
+
+size_t WireWorld::renderChanged(rt::PixelBuffer& pixelbuffer, const rt::RGBAColor palette[4])
+{
+	if (pixelbuffer.width() != _width || pixelbuffer.height() != _height) {
+		return 0;
+	}
+	std::vector<rt::RGBAColor>& pixels = pixelbuffer.pixels();
+	for (uint32_t node : _changed) {
+		pixels[_cells[node]] = palette[_states[node]];
+		_ischanged[node] = 0;
+	}
+	size_t written = _changed.size();
+	_changed.clear();
+	return written;
+}
+
+} // namespace cnv
@@ -0,0 +1,96 @@
+/**
+ * @file wireworld.h
+ * @brief cnv::WireWorld header
+ * @see https://github.com/rktrlng/pixelbuffer
+ */
+
+#ifndef WIREWORLD_H
+#define WIREWORLD_H
+
+#include <cstdint>
+#include <vector>
+
+#include <pixelbuffer/pixelbuffer.h>
+
+namespace cnv {
+
+/// @brief Runs Wireworld on a toroidal grid, only looking at what changes.
+/// The circuit doesn't change, so compile() turns it into a graph of the conductive cells and their
+/// neighbours (CSR: one list of neighbours, an offset per cell). A step only visits the neighbours of the heads.
+class WireWorld
+{
+public:
+	enum State : uint8_t
+	{
+		EMPTY = 0,
+		CONDUCTOR = 1,
+		HEAD = 2,
+		TAIL = 3
+	};
+
+	/// @brief an empty grid
+	/// @param width width
+	/// @param height height
+	WireWorld(int width, int height);
+	virtual ~WireWorld();
+
+	int width() const { return _width; }
+	int height() const { return _height; }
+	/// @brief number of steps since compile()
+	uint64_t generation() const { return _generation; }
+	/// @brief number of electron heads
+	size_t heads() const { return _heads.size(); }
+
+	/// @brief state of a cell, wraps around
+	State getCell(int x, int y) const;
+	/// @brief set the state of a cell, wraps around. The circuit is compiled again on the next step().
+	void setCell(int x, int y, State state);
+
+	/// @brief build the graph of the circuit from the cells, and find the heads
+	void compile();
+
+	/// @brief advance
+	/// @param generations number of generations
+	void step(int generations = 1);
+
+	/// @brief write all cells into a pixelbuffer of the same size (empty cells are left alone)
+	/// @param pixelbuffer the pixelbuffer
+	/// @param palette a color for CONDUCTOR, HEAD and TAIL, at those indices
+	void render(rt::PixelBuffer& pixelbuffer, const rt::RGBAColor palette[4]);
+	/// @brief write only the cells that changed since the last render into the pixelbuffer
+	/// @param pixelbuffer the pixelbuffer
+	/// @param palette a color for CONDUCTOR, HEAD and TAIL, at those indices
+	/// @return number of pixels written
+	size_t renderChanged(rt::PixelBuffer& pixelbuffer, const rt::RGBAColor palette[4]);
+
+private:
+	int _width;
+	int _height;
+	uint64_t _generation;
+	std::vector<uint8_t> _grid; // State per cell, up to date for cells without a node
+	std::vector<int32_t> _ids; // node of every cell, -1 for none
+	bool _compiled;
+
+	// the compiled circuit: node i is grid cell _cells[i]
+	std::vector<uint32_t> _cells;
+	std::vector<uint8_t> _states;
+	std::vector<uint32_t> _offsets; // neighbours of node i: _neighbours[_offsets[i] .. _offsets[i+1]]
+	std::vector<uint32_t> _neighbours; // conductive neighbours only
+
+	// worklists
+	std::vector<uint32_t> _heads;
+	std::vector<uint32_t> _tails;
+	std::vector<uint32_t> _next;
+	std::vector<uint8_t> _counts; // head neighbours, while stepping
+	std::vector<uint32_t> _counted;
+
+	// nodes that changed since the last render
+	std::vector<uint32_t> _changed;
+	std::vector<uint8_t> _ischanged;
+
+	void changed(uint32_t node);
+};
+
+} // namespace cnv
+
+#endif /* WIREWORLD_H */
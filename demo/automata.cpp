@@ -11,19 +11,26 @@
 #include <string>
 
 #include <canvas/application.h>
+#include <canvas/elementary.h>
+#include <canvas/parallel.h>
 
 class MyApp : public cnv::Application
 {
 public:
 	MyApp(uint16_t width, uint16_t height, uint8_t bitdepth, uint8_t factor) : cnv::Application(width, height, bitdepth, factor) 
 	{
-		std::srand(std::time(nullptr));
-
-		// write to rules/rule000.pbf
-		for (size_t i = 0; i < 256; i++)
-		{
-			rule(i, true);
-		}
+		m_seed = std::time(nullptr);
+
+		// write to rules/rule000.pbf, all rules at once
+		std::cout << "writing: rules/rule000.pbf .. rules/rule255.pbf" << std::endl;
+		cnv::parallel_for(256, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+			{
+				rt::PixelBuffer pixelbuffer(width, height, bitdepth);
+				rule(pixelbuffer, i);
+				pixelbuffer.write(pixelbuffer.createFilename("rules/rule", i, 2));
+			}
+		}, 1);
 	}
 
 	// MyApp(rt::PixelBuffer& pixelbuffer, uint8_t factor) : cnv::Application(pixelbuffer, factor)
@@ -47,7 +54,7 @@ public:
 		{
 			static int r = 0;
 			std::cout << "rule set: " << r << std::endl;
-			rule(r);
+			rule(layers[0]->pixelbuffer, r);
 			r++;
 			r %= 256;
 			layers[0]->lock();
@@ -57,71 +64,19 @@ public:
 	}
 
 private:
-	const std::vector<bool> nextRow(const std::vector<bool>& in_row, int rule_num) const
-	{
-		std::vector<bool> out_row(in_row.size(), 0);
-		std::vector<bool> ruleset = ruleBits(rule_num);
-
-		for (size_t x = 1; x < in_row.size()-1; x++) {
-			int index = 0;
-			if (in_row[x-1] == 1) { index += 4; }
-			if (in_row[x+0] == 1) { index += 2; }
-			if (in_row[x+1] == 1) { index += 1; }
-
-			uint8_t result = ruleset[index];
-			out_row[x] = result;
-		}
-
-		return out_row;
-	}
-
-	const std::vector<bool> ruleBits(uint8_t rule_num) const
-	{
-		// the number as an array of bits
-		std::vector<bool> ruleset(8, 0);
-		int counter = 0;
-		while (rule_num > 0)
-		{
-			ruleset[counter] = rule_num & 1;
-			rule_num >>= 1;
-			counter++;
-		}
-		return ruleset;
-	}
+	unsigned int m_seed;
 
-	void rule(uint8_t num, bool wr = false)
+	void rule(rt::PixelBuffer& pixelbuffer, uint8_t num)
 	{
-		auto& pixelbuffer = layers[0]->pixelbuffer;
-		const size_t rows = pixelbuffer.height();
 		const size_t cols = pixelbuffer.width();
 
-		// initialize first row
-		std::vector<bool> row(cols, 0);
-		row[cols/2-1] = 1; // first pixel half way
-		for (size_t i = 0; i < cols; i++)
-		{
-			row[i] = rand()%2; // random pixels on first row
-		}
+		// initialize first row, with a generator of its own (rules are drawn on different threads)
+		std::mt19937 rng(m_seed + num);
+		cnv::ElementaryCA automaton(cols, num);
+		automaton.randomize(rng); // random pixels on first row
 
 		// draw all the rows
-		for (size_t y = 0; y < rows; y++) {
-			for (size_t x = 0; x < cols; x++) {
-				rt::RGBAColor color = WHITE;
-				if (row[x]) {
-					color = BLACK;
-				}
-				pixelbuffer.setPixel(x, y, color);
-			}
-			// update row
-			row = nextRow(row, num);
-		}
-
-		if (wr)
-		{
-			std::string name = pixelbuffer.createFilename("rules/rule", num, 2);
-			std::cout << "writing: " << name << std::endl;
-			pixelbuffer.write(name);
-		}
+		automaton.render(pixelbuffer, BLACK, WHITE);
 	}
 
 	void handleInput() {
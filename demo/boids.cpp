@@ -0,0 +1,191 @@
+/**
+ * @file boids.cpp
+ *
+ * @brief Boids: flocking with separation, alignment and cohesion
+ *
+ * Copyright 2026 @rktrlng
+ * https://github.com/rktrlng/canvas
+ */
+
+#include <cmath>
+#include <ctime>
+
+#include <canvas/application.h>
+#include <canvas/spatialgrid.h>
+
+const int NUM_BOIDS = 20000;
+const float RADIUS = 6.0f; // see the others this far
+const float SEPARATION = 2.5f; // too close
+const float MIN_SPEED = 20.0f;
+const float MAX_SPEED = 50.0f;
+const float ALIGN = 1.0f; // steer with the others
+const float COHERE = 0.6f; // steer to the others
+const float SEPARATE = 3.0f; // steer away from the others
+
+class MyApp : public cnv::Application
+{
+private:
+	int m_cols;
+	int m_rows;
+	std::vector<float> m_x;
+	std::vector<float> m_y;
+	std::vector<float> m_vx;
+	std::vector<float> m_vy;
+	std::vector<float> m_nvx; // new velocities
+	std::vector<float> m_nvy;
+	cnv::SpatialGrid m_grid;
+
+public:
+	MyApp(uint16_t width, uint16_t height, uint8_t bitdepth, uint8_t factor) : cnv::Application(width, height, bitdepth, factor),
+		m_grid(width, height, RADIUS)
+	{
+		std::srand(std::time(nullptr));
+		m_cols = width;
+		m_rows = height;
+		init();
+	}
+
+	// MyApp(rt::PixelBuffer& pixelbuffer, uint8_t factor) : cnv::Application(pixelbuffer, factor)
+	// {
+	//
+	// }
+
+	virtual ~MyApp()
+	{
+
+	}
+
+	void init()
+	{
+		m_x.resize(NUM_BOIDS);
+		m_y.resize(NUM_BOIDS);
+		m_vx.resize(NUM_BOIDS);
+		m_vy.resize(NUM_BOIDS);
+		m_nvx.resize(NUM_BOIDS);
+		m_nvy.resize(NUM_BOIDS);
+		for (int i = 0; i < NUM_BOIDS; i++) {
+			m_x[i] = rt::rand_float() * m_cols;
+			m_y[i] = rt::rand_float() * m_rows;
+			rt::vec2f v = rt::vec2f::fromAngle(rt::rand_float() * 2 * 3.1415926f);
+			m_vx[i] = v.x * MIN_SPEED;
+			m_vy[i] = v.y * MIN_SPEED;
+		}
+	}
+
+	void update(float deltatime) override
+	{
+		handleInput();
+
+		static float frametime = 0.0f;
+		float maxtime = 0.01667f - deltatime;
+		frametime += deltatime;
+		if (frametime >= maxtime) {
+			flock(frametime);
+			draw();
+			layers[0]->lock();
+			frametime = 0.0f;
+		}
+	}
+
+private:
+	void flock(float dt)
+	{
+		// who is near who
+		m_grid.build(m_x.data(), m_y.data(), NUM_BOIDS);
+
+		// every boid reads the others, and only writes its own new velocity
+		m_grid.queryAll(RADIUS, [&](uint32_t i, const uint32_t* others, size_t count) {
+			float vx = m_vx[i];
+			float vy = m_vy[i];
+			if (count > 0) {
+				float ax = 0, ay = 0; // average velocity
+				float cx = 0, cy = 0; // average position
+				float sx = 0, sy = 0; // away from the ones too close
+				for (size_t n = 0; n < count; n++) {
+					uint32_t j = others[n];
+					ax += m_vx[j];
+					ay += m_vy[j];
+					float dx = m_x[i] - m_x[j];
+					float dy = m_y[i] - m_y[j];
+					cx -= dx;
+					cy -= dy;
+					float d2 = dx * dx + dy * dy;
+					if (d2 < SEPARATION * SEPARATION && d2 > 0.0f) {
+						sx += dx / d2;
+						sy += dy / d2;
+					}
+				}
+				ax /= count;
+				ay /= count;
+				cx /= count;
+				cy /= count;
+				vx += ((ax - vx) * ALIGN + cx * COHERE + sx * SEPARATE * MAX_SPEED) * dt;
+				vy += ((ay - vy) * ALIGN + cy * COHERE + sy * SEPARATE * MAX_SPEED) * dt;
+			}
+
+			float speed = std::sqrt(vx * vx + vy * vy);
+			if (speed > MAX_SPEED) { vx *= MAX_SPEED / speed; vy *= MAX_SPEED / speed; }
+			if (speed < MIN_SPEED && speed > 0.0f) { vx *= MIN_SPEED / speed; vy *= MIN_SPEED / speed; }
+			m_nvx[i] = vx;
+			m_nvy[i] = vy;
+		});
+
+		m_vx.swap(m_nvx);
+		m_vy.swap(m_nvy);
+		for (int i = 0; i < NUM_BOIDS; i++) {
+			m_x[i] += m_vx[i] * dt;
+			m_y[i] += m_vy[i] * dt;
+			if (m_x[i] < 0) m_x[i] += m_cols;
+			if (m_x[i] >= m_cols) m_x[i] -= m_cols;
+			if (m_y[i] < 0) m_y[i] += m_rows;
+			if (m_y[i] >= m_rows) m_y[i] -= m_rows;
+		}
+	}
+
+	void draw()
+	{
+		auto& pixelbuffer = layers[0]->pixelbuffer;
+		pixelbuffer.fill(BLACK);
+
+		// color by heading
+		for (int i = 0; i < NUM_BOIDS; i++) {
+			float angle = std::atan2(m_vy[i], m_vx[i]);
+			rt::HSVAColor hsva = rt::RGBA2HSVA(RED);
+			hsva.h = (angle + 3.1415926f) / (2 * 3.1415926f);
+			hsva.s = 0.6f;
+			hsva.v = 1;
+			pixelbuffer.setPixel(m_x[i], m_y[i], rt::HSVA2RGBA(hsva));
+		}
+	}
+
+	void handleInput()
+	{
+		if (input.getKeyDown(cnv::KeyCode::Space)) {
+			std::cout << "spacebar pressed down." << std::endl;
+			init();
+		}
+
+		if (input.getMouseDown(0)) {
+			std::cout << "click " << (int) input.getMouseX() << "," << (int) input.getMouseY() << std::endl;
+		}
+
+		int scrolly = input.getScrollY();
+		if (scrolly != 0) {
+			std::cout << "scroll: " << scrolly << std::endl;
+		}
+	}
+
+};
+
+
+int main( void )
+{
+	MyApp application(480, 270, 24, 3);
+
+	while (!application.quit())
+	{
+		application.run();
+	}
+
+	return 0;
+}
@@ -7,10 +7,13 @@
  * https://github.com/rktrlng/canvas
  */
 
+#include <chrono>
 #include <ctime>
 #include <string>
 
 #include <canvas/application.h>
+#include <canvas/distancefield.h>
+#include <canvas/life.h>
 
 class MyApp : public cnv::Application
 {
@@ -20,9 +23,16 @@ public:
 	// 	init();
 	// }
 
-	MyApp(rt::PixelBuffer& pixelbuffer, uint8_t factor) : cnv::Application(pixelbuffer, factor)
+	// a wall with 3 or more walls around it stays, an open space with 5 or more walls around it becomes a wall
+	MyApp(rt::PixelBuffer& pixelbuffer, uint8_t factor) : cnv::Application(pixelbuffer, factor),
+		m_life(pixelbuffer.width(), pixelbuffer.height(), cnv::LifeRule("B5678/S345678"))
 	{
+		setStepRate(4); // iterations per second
 		init();
+
+		// the distances from a click, over the cave
+		m_distances = new cnv::Canvas(pixelbuffer.width(), pixelbuffer.height(), 32, factor);
+		layers.push_back(m_distances);
 	}
 
 	virtual ~MyApp()
@@ -38,16 +48,12 @@ public:
 
 		std::srand(std::time(nullptr));
 		random(60);
-		// fill field for cave
-		m_field = std::vector<uint8_t>(rows*cols, 0);
-		int counter = 0;
+		// fill field for cave (alive is a wall)
+		m_life.clear();
 		for (size_t y = 0; y < rows; y++) {
 			for (size_t x = 0; x < cols; x++) {
 				rt::RGBAColor color = pixelbuffer.getPixel(x, y);
-				if (color == BLACK) { m_field[counter] = 0; }
-				if (color == WHITE) { m_field[counter] = 1; }
-
-				counter++;
+				if (color == BLACK) { m_life.setCell(x, y, 1); }
 			}
 		}
 	}
@@ -56,37 +62,31 @@ public:
 	{
 		handleInput();
 
-		static float frametime = 0.0f;
-		float maxtime = 0.25f;
-		frametime += deltatime;
-		if (frametime >= maxtime)
-		{
-			const int iterations = 30;
-			static int count = 0;
-			if (count < iterations) {
-				cave();
-				std::cout << count << "\n";
-			}
-			count++;
-			if ( count > iterations) {
-				count = iterations;
+		if (m_count < ITERATIONS) {
+			cave();
+			std::cout << m_count << "\n";
+		}
+		m_count++;
+		if (m_count > ITERATIONS) {
+			m_count = ITERATIONS;
+			// nothing left to do without a window
+			if (headless()) {
+				stop();
 			}
-			layers[0]->lock();
-
-			frametime = 0.0f;
 		}
+		layers[0]->lock();
 	}
 
 private:
-	// internal data to work with (value are 0,1)
-	std::vector<uint8_t> m_field;
+	// internal data to work with (values are 0,1)
+	cnv::LifeEngine m_life;
+	const int ITERATIONS = 30;
+	int m_count = 0;
+	cnv::Canvas* m_distances; // owned by layers
 
 	void cave()
 	{
-		// get pixelbuffer, rows and cols
 		auto& pixelbuffer = layers[0]->pixelbuffer;
-		size_t rows = pixelbuffer.height();
-		size_t cols = pixelbuffer.width();
 
 		{
 			static int counter = 0;
@@ -96,39 +96,8 @@ private:
 			counter++;
 		}
 
-		// set the next state
-		std::vector<uint8_t> next = std::vector<uint8_t>(cols*rows, 0);
-		for (size_t y = 0; y < rows; y++) {
-			for (size_t x = 0; x < cols; x++) {
-				// Apply rules for each pixel:
-				int current = m_field[rt::index(x,y,cols)];
-
-				// check 8 neighbours and count the ones that are a WALL (black)
-				int nc = 0; // number of neighbour cells
-				for (int r = -1; r < 2; r++) {
-					for (int c = -1; c < 2; c++) {
-						rt::vec2i n = rt::wrap(rt::vec2i(x+c, y+r), cols, rows);
-						if (m_field[rt::index(n.x,n.y,cols)] == 0) { nc++; }
-					}
-				}
-				if (nc < 4) { current = 1; }
-				if (nc > 4) { current = 0; }
-				next[rt::index(x,y,cols)] = current;
-
-				// update pixelbuffer from (current) field
-				rt::RGBAColor color;
-				int index = rt::index(x,y,cols);
-				if (m_field[index] == 0) {
-					color = BLACK;
-				} else {
-					color = WHITE;
-				}
-				pixelbuffer.setPixel(x, y, color);
-			}
-		}
-
-		// update field to next state
-		m_field = next;
+		m_life.step();
+		m_life.render(pixelbuffer, BLACK, WHITE);
 	}
 
 	void handleInput() {
@@ -138,8 +107,14 @@ private:
 		}
 
 		if (input.getMouseDown(0)) {
-			std::cout << "click " << (int) input.getMouseX() << "," << (int) input.getMouseY() << std::endl;
-			layers[0]->pixelbuffer.blur();
+			int x = (int) input.getMouseX();
+			int y = (int) input.getMouseY();
+			std::cout << "click " << x << "," << y << std::endl;
+			if (m_count < ITERATIONS) {
+				layers[0]->pixelbuffer.blur();
+			} else {
+				distances(rt::vec2i(x, y));
+			}
 		}
 
 		int scrolly = input.getScrollY();
@@ -148,6 +123,25 @@ private:
 		}
 	}
 
+	// color the cave by the number of steps from the source, when it's done
+	void distances(rt::vec2i source) {
+		cnv::GridMap map(layers[0]->pixelbuffer);
+		cnv::DistanceField field(map);
+
+		auto start = std::chrono::steady_clock::now();
+		size_t reached = field.compute(source);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (reached == 0) {
+			std::cout << "that's a wall" << std::endl;
+			return;
+		}
+		std::cout << "reached " << reached << " cells, furthest " << field.maximum() << " steps (";
+		std::cout << field.topdown() << " levels top-down, " << field.bottomup() << " bottom-up) in " << seconds * 1000 << " ms" << std::endl;
+
+		field.render(m_distances->pixelbuffer);
+		m_distances->lock();
+	}
+
 	void random(int percentage = 50) {
 		// get pixelbuffer, rows and cols
 		auto& pixelbuffer = layers[0]->pixelbuffer;
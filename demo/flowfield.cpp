@@ -8,24 +8,33 @@
  */
 
 #include <ctime>
-#include <deque>
 
 #include <canvas/application.h>
 #include <canvas/noise.h>
+#include <canvas/flowfield.h>
+#include <canvas/particles.h>
+#include <canvas/trailcanvas.h>
 
 class MyApp : public cnv::Application
 {
 private:
 	cnv::PerlinNoise m_pn;
-	std::vector<rt::vec2f> m_field;
-	std::deque<rt::vec2f> m_particles;
-	size_t m_flowscale = 8;
+	std::vector<cnv::PerlinNoise::Octave> m_octaves;
+	cnv::FlowField* m_field;
+	static const int FLOWSCALE = 8; // pixels per cell of the field
 	const size_t MAXPARTICLES = 2500;
 	const double ZSPEED = 0.001; // z-noise change
 	const int PSPEED = 50; // particle speed
 	const int AT_ONCE = 6; // # of particles to spawn per tick
+	const float TICK = 0.05f; // seconds
+	const float LIFETIME = MAXPARTICLES / AT_ONCE * TICK; // seconds
+	const float DECAY = 0.9f; // light left of the trails after a tick
+	cnv::ParticleSystem m_particles;
+	cnv::TrailCanvas* m_trails; // owned by layers
 public:
-	MyApp(uint16_t width, uint16_t height, uint8_t bitdepth, uint8_t factor) : cnv::Application(width, height, bitdepth, factor)
+	// layers[0] shows the noise of the field, a pixel per cell
+	MyApp(uint16_t width, uint16_t height, uint8_t bitdepth, uint8_t factor) : cnv::Application(width/FLOWSCALE, height/FLOWSCALE, bitdepth, factor*FLOWSCALE),
+		m_particles(MAXPARTICLES, time(nullptr))
 	{
 		srand((unsigned)time(nullptr));
 
@@ -33,14 +42,42 @@ public:
 		// unsigned int seed = 42;
 		m_pn = cnv::PerlinNoise(seed);
 
-		cnv::Canvas* particleCanvas = new cnv::Canvas(width, height, bitdepth, factor);
-		layers.push_back(particleCanvas);
-		particleCanvas->pixelbuffer.fill(BLACK);
+		// { frequency, multiplier }
+		// m_octaves.push_back( { 1, 32} );
+		// m_octaves.push_back( { 2, 16} );
+		// m_octaves.push_back( { 4, 8} );
+		m_octaves.push_back( { 8, 4} );
+		m_octaves.push_back( {16, 2} );
+		m_octaves.push_back( {32, 1} );
+
+		m_field = new cnv::FlowField(m_pn, width/FLOWSCALE, height/FLOWSCALE, m_octaves);
+
+		// trails of the particles, colored from red (bright) to blue (faint)
+		m_trails = new cnv::TrailCanvas(width, height, bitdepth, factor);
+		layers.push_back(m_trails);
+		std::vector<rt::RGBAColor> palette;
+		for (int i = 0; i < 256; i++) {
+			rt::HSVAColor hsva = rt::RGBA2HSVA(RED);
+			hsva.v = i / 255.0f;
+			hsva.h = 0.999f - hsva.v;
+			hsva.s = 1;
+			palette.push_back(rt::HSVA2RGBA(hsva));
+		}
+		m_trails->setPalette(palette);
+
+		// particles anywhere, flowing along with the field
+		cnv::ParticleSystem::Emitter anywhere;
+		anywhere.position = rt::vec2f(width/2, height/2);
+		anywhere.area = rt::vec2f(width, height);
+		anywhere.rate = AT_ONCE / TICK;
+		anywhere.lifetime = LIFETIME;
+		m_particles.addEmitter(anywhere);
+		m_particles.setFlowField(m_field, FLOWSCALE, PSPEED);
+		m_particles.setBounds(width, height, cnv::ParticleSystem::WRAP);
 
 		// fill list of particles half way
 		for (size_t i = 0; i < MAXPARTICLES/2; i++) {
-			rt::vec2f p = { rt::rand_float()*width, rt::rand_float()*height };
-			m_particles.push_back(p);
+			m_particles.spawn(rt::rand_float()*width, rt::rand_float()*height, 0.0f, 0.0f, rt::rand_float()*LIFETIME);
 		}
 	}
 
@@ -51,7 +88,7 @@ public:
 
 	virtual ~MyApp()
 	{
-
+		delete m_field;
 	}
 
 	void update(float deltatime) override
@@ -59,16 +96,15 @@ public:
 		handleInput();
 		
 		static float frametime = 0.0f;
-		float maxtime = 0.05f;
+		float maxtime = TICK;
 		frametime += deltatime;
 		if (frametime >= maxtime)
 		{
 			noise();
-			updateFlowm_field();
 			handleParticles(frametime);
 
 			layers[0]->lock();
-			layers[1]->lock();
+			m_trails->lock();
 
 			frametime = 0.0f;
 		}
@@ -77,106 +113,11 @@ public:
 private:
 	void handleParticles(float deltatime)
 	{
-		auto& pixelbuffer = layers[1]->pixelbuffer;
-		int rows = pixelbuffer.height();
-		int cols = pixelbuffer.width();
-
-		// update positions
-		for (size_t i = 0; i < m_particles.size(); i++) {
-			auto& particle = m_particles[i];
-
-			int flowindex = rt::index(particle.x/m_flowscale, particle.y/m_flowscale, cols/m_flowscale);
-			particle.x += m_field[flowindex].x * deltatime * PSPEED;
-			particle.y += m_field[flowindex].y * deltatime * PSPEED;
-
-			if (particle.x < 0) particle.x = cols-1;
-			if (particle.x > cols) particle.x = 0;
-			if (particle.y < 0) particle.y = rows-1;
-			if (particle.y > rows) particle.y = 0;
-		}
-
-		// draw particles
-		for (size_t i = 0; i < m_particles.size(); i++) {
-			rt::vec2f particle = m_particles[i];
-			pixelbuffer.setPixel(particle.x, particle.y, WHITE);
-		}
-
-		// handle number of particles
-		for (int i = 0; i < AT_ONCE; i++) {
-			rt::vec2f p = { rt::rand_float()*cols, rt::rand_float()*rows };
-			// rt::vec2f p = { rt::rand_bm()*cols, rt::rand_bm()*rows };
-			// rt::vec2f p = { (float)cols/2, (float)rows/2 };
-
-			m_particles.push_back(p);
-
-			if (m_particles.size() > MAXPARTICLES) {
-				m_particles.pop_front();
-			}
-		}
-
-		pixelbuffer.blur();
-
-		// Colorize
-		for (size_t i = 0; i < pixelbuffer.pixels().size(); i++) {
-			rt::HSVAColor hsva = rt::RGBA2HSVA(pixelbuffer[i]);
-			hsva.h = 0.999f - hsva.v;
-			hsva.s = 1;
-			pixelbuffer[i] = rt::HSVA2RGBA(hsva);
-		}
+		m_particles.update(deltatime);
+		m_trails->decay(DECAY);
+		m_particles.splat(*m_trails, WHITE);
 	}
 	
-	void updateFlowm_field()
-	{
-		m_field.clear();
-
-		auto& pixelbuffer = layers[0]->pixelbuffer;
-		size_t rows = pixelbuffer.height();
-		size_t cols = pixelbuffer.width();
-
-		// find min + max
-		auto& colors = pixelbuffer.pixels();
-		uint8_t min = 255;
-		uint8_t max = 0;
-		for (size_t i = 0; i < colors.size(); i++) {
-			if (colors[i].r < min) min = colors[i].r;
-			if (colors[i].r > max) max = colors[i].r;
-		}
-
-		// noise to m_field values
-		for (size_t y = 0; y < rows; y += m_flowscale) {
-			for (size_t x = 0; x < cols; x += m_flowscale) {
-				rt::RGBAColor color = pixelbuffer.getPixel(x+m_flowscale/2, y+m_flowscale/2);
-				float angle = rt::map(color.r, min, max, -3.1415926f*1.9f, 3.1415926f*1.9f);
-				rt::vec2f vec = rt::vec2f::fromAngle(angle);
-				m_field.push_back(vec);
-			}
-		}
-	}
-
-	struct Octave
-	{
-		int freq = 1;
-		int multiplier = 1;
-		Octave(int f, int m) : freq(f), multiplier(m) { }
-	};
-
-	double coherentNoise(double x, double y, double z, const std::vector<Octave>& octaves)
-	{
-		double n = 0.0;
-		double div = 0.0;
-
-		for (size_t i = 0; i < octaves.size(); i++) {
-			int freq = octaves[i].freq;
-			int mult = octaves[i].multiplier;
-			double a = m_pn.noise(x*freq, y*freq, z*freq) * mult;
-			n += a;
-			div += mult;
-		}
-		n /= div;
-
-		return n;
-	}
-
 	void noise()
 	{
 		auto& pixelbuffer = layers[0]->pixelbuffer;
@@ -184,43 +125,9 @@ private:
 		static double z = 0.0f;
 		z += ZSPEED;
 
-		size_t rows = pixelbuffer.height();
-		size_t cols = pixelbuffer.width();
-		for (size_t i = 0; i < rows; i++) {
-			for (size_t j = 0; j < cols; j++) {
-				double x = (double)j/((double)cols);
-				double y = (double)i/((double)rows);
-				// double z = 0.0f;
-
-				std::vector<Octave> octaves; // { frequency, multiplier }
-				// octaves.push_back( { 1, 32} );
-				// octaves.push_back( { 2, 16} );
-				// octaves.push_back( { 4, 8} );
-				octaves.push_back( { 8, 4} );
-				octaves.push_back( {16, 2} );
-				octaves.push_back( {32, 1} );
-				double n = coherentNoise(x, y, z, octaves);
-
-				uint8_t p = 255 * n;
+		m_field->update(z);
+		m_field->render(pixelbuffer);
 
-				// posterize
-				if (false) {
-					int numcolors = 9;
-					p = rt::map(p, 0, 255, 0, numcolors); // narrow down
-					p = rt::map(p, 0, numcolors, 0, 255); // stretch back
-				}
-
-				// Wood like structure
-				if (false) {
-					n = 20 * m_pn.noise(x, y, z);
-					n = n - floor(n);
-					p = 255 * n;
-				}
-
-				rt::RGBAColor color = rt::RGBAColor(p, p, p, 255);
-				pixelbuffer.setPixel(j, i, color);
-			}
-		}
 		// pixelbuffer.blur();
 		pixelbuffer.contrast_8();
 	}
@@ -231,6 +138,12 @@ private:
 			layers[0]->pixelbuffer.printInfo();
 		}
 
+		if (input.getKeyDown(cnv::KeyCode::C)) {
+			bool curl = m_field->mode() == cnv::FlowField::ANGLE;
+			m_field->setMode(curl ? cnv::FlowField::CURL : cnv::FlowField::ANGLE);
+			std::cout << (curl ? "curl" : "angle") << std::endl;
+		}
+
 		if (input.getMouseDown(0)) {
 			std::cout << "click " << (int) input.getMouseX() << "," << (int) input.getMouseY() << std::endl;
 		}
@@ -10,6 +10,7 @@
 #include <ctime>
 
 #include <canvas/application.h>
+#include <canvas/life.h>
 
 class MyApp : public cnv::Application
 {
@@ -19,8 +20,11 @@ public:
     // 	init();
     // }
 
-    MyApp(rt::PixelBuffer &pixelbuffer, uint8_t factor) : cnv::Application(pixelbuffer, factor)
+    // a cell is alive when an odd number of its neighbours is
+    MyApp(rt::PixelBuffer &pixelbuffer, uint8_t factor) : cnv::Application(pixelbuffer, factor),
+        m_life(pixelbuffer.width(), pixelbuffer.height(), cnv::LifeRule("B1357/S1357"))
     {
+        setStepRate(2); // generations per second
         init();
     }
 
@@ -38,116 +42,40 @@ public:
         pixelbuffer.fill(BLACK);
 
         // fill field for fredkin replicator
-        m_field = std::vector<uint8_t>(rows * cols, 0);
-        int center = ((rows*cols)/2) + (cols/2);
-        m_field[center] = 1;
+        m_life.clear();
+        m_life.setCell(cols / 2, rows / 2, ALIVE);
     }
 
     void update(float deltatime) override
     {
         handleInput();
 
-        static float frametime = 0.0f;
-        float maxtime = 0.5f;
-        frametime += deltatime;
-
         int lastgeneration = 64;
         static int currentgeneration = 0;
-        if (frametime >= maxtime)
+        currentgeneration++;
+        if (currentgeneration > lastgeneration)
         {
-            currentgeneration++;
-            if (currentgeneration > lastgeneration)
-            {
-                init();
-                currentgeneration = 1;
-            }
-            std::cout << "generation: " << currentgeneration << "\n";
-
-            fredkinreplicator();
-
-            // std::string filename = "fredkin_";
-            // filename.append(std::to_string(currentgeneration));
-            // filename.append(".tga");
-            // layers[0]->pixelbuffer.writeTGA(filename);
-            
-            layers[0]->lock();
-            frametime = 0.0f;
+            init();
+            currentgeneration = 1;
         }
-    }
+        std::cout << "generation: " << currentgeneration << "\n";
 
-private:
-    const uint8_t DEAD = 0;  // BLACK
-    const uint8_t ALIVE = 1; // WHITE
+        m_life.step();
+        m_life.render(layers[0]->pixelbuffer, WHITE, BLACK);
 
-    // internal data to work with (value are 0,1)
-    std::vector<uint8_t> m_field;
+        // std::string filename = "fredkin_";
+        // filename.append(std::to_string(currentgeneration));
+        // filename.append(".tga");
+        // layers[0]->pixelbuffer.writeTGA(filename);
 
-    void fredkinreplicator()
-    {
-        // get pixelbuffer, rows and cols
-        auto &pixelbuffer = layers[0]->pixelbuffer;
-        size_t rows = pixelbuffer.height();
-        size_t cols = pixelbuffer.width();
+        layers[0]->lock();
+    }
 
-        // set the next state
-        std::vector<uint8_t> next = std::vector<uint8_t>(cols * rows, 0);
-        for (size_t y = 0; y < rows; y++)
-        {
-            for (size_t x = 0; x < cols; x++)
-            {
-                int index = rt::index(x, y, cols);
-                uint8_t current = m_field[index];
-
-                // check 8 neighbours and count the ones that are a ALIVE
-                int nc = 0; // number of neighbour cells
-                for (int r = -1; r < 2; r++)
-                {
-                    for (int c = -1; c < 2; c++)
-                    {
-                        if (r == 0 && c == 0)
-                        {
-                            // this is us
-                        }
-                        else
-                        {
-                            rt::vec2i n = rt::wrap(rt::vec2i(x + c, y + r), cols, rows);
-                            if (m_field[rt::index(n.x, n.y, cols)] == ALIVE)
-                            {
-                                nc++;
-                            }
-                        }
-                    }
-                }
-
-                // Apply rules for each pixel:
-                if (nc % 2 == 0)
-                {
-                    current = DEAD;
-                }
-                else
-                {
-                    current = ALIVE;
-                }
-
-                next[index] = current;
-
-                // update pixelbuffer from (current) field
-                rt::RGBAColor color;
-                if (m_field[index] == ALIVE)
-                {
-                    color = WHITE;
-                }
-                else
-                {
-                    color = BLACK;
-                }
-                pixelbuffer.setPixel(x, y, color);
-            }
-        }
+private:
+    const uint8_t ALIVE = 1; // WHITE
 
-        // update field to next state
-        m_field = next;
-    }
+    // internal data to work with (values are 0,1)
+    cnv::LifeEngine m_life;
 
     void handleInput()
     {
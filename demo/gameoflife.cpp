@@ -10,6 +10,7 @@
 #include <ctime>
 
 #include <canvas/application.h>
+#include <canvas/bitlife.h>
 
 class MyApp : public cnv::Application
 {
@@ -19,8 +20,10 @@ public:
 	// 	init();
 	// }
 
-	MyApp(rt::PixelBuffer& pixelbuffer, uint8_t factor) : cnv::Application(pixelbuffer, factor)
+	MyApp(rt::PixelBuffer& pixelbuffer, uint8_t factor) : cnv::Application(pixelbuffer, factor),
+		m_life(pixelbuffer.width(), pixelbuffer.height(), cnv::LifeRule("B3/S23"))
 	{
+		setStepRate(10); // generations per second
 		init();
 	}
 
@@ -39,7 +42,7 @@ public:
 		pixelbuffer.fill(BLACK);
 		
 		// fill field for game of life
-		m_field = std::vector<uint8_t>(rows*cols, 0);
+		m_life.clear();
 
 		pentomino(rt::vec2i(cols / 4, rows / 2));
 		pentomino(rt::vec2i(cols / 4 * 3, rows / 2), 1);
@@ -51,45 +54,32 @@ public:
 	{
 		handleInput();
 
-		static float frametime = 0.0f;
-		float maxtime = 0.1f;
-		frametime += deltatime;
-		if (frametime >= maxtime)
-		{
-			gameoflife();
-			agitator(rt::vec2i(0, 0));
-			layers[0]->lock();
-
-			frametime = 0.0f;
-		}
+		m_life.step();
+		m_life.render(layers[0]->pixelbuffer, 0, 0, WHITE, BLACK);
+		agitator(rt::vec2i(0, 0));
+		layers[0]->lock();
 	}
 
 private:
-	const uint8_t DEAD = 0; // BLACK
 	const uint8_t ALIVE = 1; // WHITE
 
-	// internal data to work with (value are 0,1)
-	std::vector<uint8_t> m_field;
+	// internal data to work with (64 cells per word)
+	cnv::BitLife m_life;
 
 	void pentomino(const rt::vec2i& pos, int dir = 0)
 	{
-		auto& pixelbuffer = layers[0]->pixelbuffer;
-		int cols = pixelbuffer.width();
-		// int rows = pixelbuffer.header().height;
-
-		int id = rt::index(pos.x, pos.y, cols);
 		if (dir) {
-			m_field[id-1] = ALIVE;
-			m_field[id+0] = ALIVE;
-			m_field[id+1] = ALIVE;
-			m_field[id+0-cols] = ALIVE;
-			m_field[id-1+cols] = ALIVE;
+			m_life.setCell(pos.x-1, pos.y, ALIVE);
+			m_life.setCell(pos.x+0, pos.y, ALIVE);
+			m_life.setCell(pos.x+1, pos.y, ALIVE);
+			m_life.setCell(pos.x+0, pos.y-1, ALIVE);
+			m_life.setCell(pos.x-1, pos.y+1, ALIVE);
 		} else {
-			m_field[id+0] = ALIVE;
-			m_field[id+0+cols] = ALIVE;
-			m_field[id+0-cols] = ALIVE;
-			m_field[id+0-1] = ALIVE;
-			m_field[id+cols+1] = ALIVE;
+			m_life.setCell(pos.x+0, pos.y, ALIVE);
+			m_life.setCell(pos.x+0, pos.y+1, ALIVE);
+			m_life.setCell(pos.x+0, pos.y-1, ALIVE);
+			m_life.setCell(pos.x-1, pos.y, ALIVE);
+			m_life.setCell(pos.x+1, pos.y+1, ALIVE);
 		}
 	}
 
@@ -104,8 +94,7 @@ private:
 		}
 
 		pixelbuffer.setPixel(pos.x, pos.y, BLACK);
-		int id = rt::index(pos.x, pos.y, cols);
-		m_field[id] = ALIVE;
+		m_life.setCell(pos.x, pos.y, ALIVE);
 
 		pos.x += (rand()%3) - 1;
 		pos.y += (rand()%3) - 1;
@@ -114,56 +103,6 @@ private:
 		pixelbuffer.setPixel(pos.x, pos.y, RED);
 	}
 
-	void gameoflife()
-	{
-		// get pixelbuffer, rows and cols
-		auto& pixelbuffer = layers[0]->pixelbuffer;
-		size_t rows = pixelbuffer.height();
-		size_t cols = pixelbuffer.width();
-
-		// set the next state
-		std::vector<uint8_t> next = std::vector<uint8_t>(cols*rows, 0);
-		for (size_t y = 0; y < rows; y++) {
-			for (size_t x = 0; x < cols; x++) {
-				int index = rt::index(x,y,cols);
-				uint8_t current = m_field[index];
-
-				// check 8 neighbours and count the ones that are a ALIVE
-				int nc = 0; // number of neighbour cells
-				for (int r = -1; r < 2; r++) {
-					for (int c = -1; c < 2; c++) {
-						if (r == 0 && c == 0) {
-							// this is us
-						} else {
-							rt::vec2i n = rt::wrap(rt::vec2i(x+c, y+r), cols, rows);
-							if (m_field[rt::index(n.x,n.y,cols)] == ALIVE) { nc++; }
-						}
-					}
-				}
-
-				// Apply rules for each pixel:
-				// if ((nc == 2 || nc == 3) && current == ALIVE) { current = ALIVE; } // ALIVE on
-				if (nc < 2) { current = DEAD; } // lonely
-				if (nc > 3) { current = DEAD; } // overpopulation
-				if (nc == 3) { current = ALIVE; } // reproduction
-
-				next[index] = current;
-
-				// update pixelbuffer from (current) field
-				rt::RGBAColor color;
-				if (m_field[index] == ALIVE) {
-					color = WHITE;
-				} else {
-					color = BLACK;
-				}
-				pixelbuffer.setPixel(x, y, color);
-			}
-		}
-
-		// update field to next state
-		m_field = next;
-	}
-
 	void handleInput() {
 		if (input.getKeyDown(cnv::KeyCode::Space)) {
 			std::cout << "spacebar pressed down." << std::endl;
@@ -172,6 +111,18 @@ private:
 			// layers[0]->pixelbuffer.write("gameoflife.pbf");
 		}
 
+		if (input.getKeyDown(cnv::KeyCode::T)) {
+			// turbo: as many generations as possible, show 30 per second
+			if (stepRate() == 0) {
+				setStepRate(10);
+				setRenderRate(0);
+			} else {
+				setStepRate(0);
+				setRenderRate(30);
+			}
+			std::cout << "turbo " << (stepRate() == 0 ? "on" : "off") << std::endl;
+		}
+
 		if (input.getMouseDown(0)) {
 			std::cout << "click " << (int) input.getMouseX() << "," << (int) input.getMouseY() << std::endl;
 		}
@@ -0,0 +1,119 @@
+/**
+ * @file hashlife.cpp
+ *
+ * @brief HashLife: Game Of Life, billions of generations at a time
+ *
+ * Copyright 2026 @rktrlng
+ * https://github.com/rktrlng/canvas
+ */
+
+#include <canvas/application.h>
+#include <canvas/hashlife.h>
+
+class MyApp : public cnv::Application
+{
+public:
+	MyApp(uint16_t width, uint16_t height, uint8_t bitdepth, uint8_t factor) : cnv::Application(width, height, bitdepth, factor)
+	{
+		setStepRate(10); // steps per second
+		init();
+	}
+
+	virtual ~MyApp()
+	{
+
+	}
+
+	void init()
+	{
+		m_life.clear();
+		m_life.setRule(cnv::LifeRule(m_fredkin ? "B1357/S1357" : "B3/S23"));
+
+		if (m_fredkin) {
+			// a single cell, replicated
+			m_life.setCell(0, 0, 1);
+		} else {
+			// R-pentomino, settles after 1103 generations
+			m_life.setCell(0, -1, 1);
+			m_life.setCell(1, -1, 1);
+			m_life.setCell(-1, 0, 1);
+			m_life.setCell(0, 0, 1);
+			m_life.setCell(0, 1, 1);
+		}
+		show();
+	}
+
+	void update(float deltatime) override
+	{
+		handleInput();
+
+		m_life.stepPow2(m_exponent);
+		show();
+		std::cout << "generation: " << m_life.generation() << " population: " << m_life.population() << " nodes: " << m_life.nodes() << "\n";
+	}
+
+private:
+	cnv::HashLife m_life;
+	bool m_fredkin = false;
+	int m_exponent = 0; // 2^m_exponent generations per step
+	int m_zoom = 0; // 2^m_zoom x 2^m_zoom cells per pixel
+
+	void show()
+	{
+		// keep (0,0) in the middle of the window
+		auto& pixelbuffer = layers[0]->pixelbuffer;
+		int64_t pixel = 1LL << m_zoom;
+		int64_t left = -(pixelbuffer.width() / 2) * pixel;
+		int64_t top = -(pixelbuffer.height() / 2) * pixel;
+		m_life.render(pixelbuffer, left, top, m_zoom, WHITE, BLACK);
+		layers[0]->lock();
+	}
+
+	void handleInput() {
+		if (input.getKeyDown(cnv::KeyCode::Space)) {
+			std::cout << "spacebar pressed down." << std::endl;
+			layers[0]->pixelbuffer.printInfo();
+			init();
+		}
+
+		if (input.getKeyDown(cnv::KeyCode::F)) {
+			m_fredkin = !m_fredkin;
+			std::cout << "rule: " << (m_fredkin ? "fredkin" : "life") << std::endl;
+			init();
+		}
+
+		// faster, slower
+		if (input.getKeyDown(cnv::KeyCode::Up) && m_exponent < 40) {
+			m_exponent++;
+			std::cout << "step: 2^" << m_exponent << std::endl;
+		}
+		if (input.getKeyDown(cnv::KeyCode::Down) && m_exponent > 0) {
+			m_exponent--;
+			std::cout << "step: 2^" << m_exponent << std::endl;
+		}
+
+		// zoom out, zoom in
+		int scrolly = input.getScrollY();
+		if (scrolly != 0) {
+			m_zoom -= scrolly;
+			if (m_zoom < 0) { m_zoom = 0; }
+			if (m_zoom > 40) { m_zoom = 40; }
+			std::cout << "zoom: 2^" << m_zoom << std::endl;
+			show();
+		}
+	}
+};
+
+
+int main( void )
+{
+	MyApp application(320, 180, 24, 4); // width, height, bitdepth, factor
+	application.hideMouse();
+
+	while (!application.quit())
+	{
+		application.run();
+	}
+
+	return 0;
+}
@@ -7,79 +7,79 @@
  * https://github.com/rktrlng/canvas
  */
 
+#include <climits>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
-#include <vector>
-#include <bitset>
+#include <string>
 
 #include <canvas/application.h>
-
-struct MCell {
-	int col = 0; // x
-	int row = 0; // y
-	// 0001 = top
-	// 0010 = right
-	// 0100 = bottom
-	// 1000 = left
-	// 0000 = no walls
-	// 1111 = all walls
-	std::bitset<4> walls = 15;
-	bool visited = false;
-};
-
+#include <canvas/mazegenerator.h>
+#include <canvas/mazestream.h>
+#include <canvas/parallel.h>
 
 const int WIDTH  = 32;
 const int HEIGHT = 24;
 
+// draw the maze, with the start and the end
+void drawMaze(const cnv::MazeGenerator& maze, rt::PixelBuffer& pixelbuffer)
+{
+	maze.render(pixelbuffer);
+	pixelbuffer.setPixel(1, 1, RED); // start
+	pixelbuffer.setPixel(maze.cols()*2-1, maze.rows()*2-1, BLUE); // end
+}
+
+// write count mazes, without a window, on all cores
+void batch(int count, cnv::MazeGenerator::Algorithm algorithm)
+{
+	unsigned int seed = std::time(nullptr);
+	cnv::parallel_for(count, [&](size_t begin, size_t end) {
+		cnv::MazeGenerator maze(WIDTH, HEIGHT);
+		rt::PixelBuffer pixelbuffer(WIDTH*2+1, HEIGHT*2+1, 24);
+		for (size_t i = begin; i < end; i++) {
+			maze.seed(seed + i);
+			maze.generate(algorithm);
+			drawMaze(maze, pixelbuffer);
+			pixelbuffer.write(pixelbuffer.createFilename("maze", i));
+		}
+	}, 64);
+	std::cout << "wrote " << count << " mazes" << std::endl;
+}
+
+// write a single maze of any size, a row at a time
+int stream(uint32_t cols, uint32_t rows, const std::string& filename)
+{
+	cnv::MazeStream maze(cols, rows, std::time(nullptr));
+	if (!maze.write(filename)) {
+		std::cout << "can't write " << filename << std::endl;
+		return 1;
+	}
+	std::cout << "wrote " << filename << (maze.format() == cnv::MazeStream::PBF ? " (pbf)" : " (pbm)") << std::endl;
+	return 0;
+}
+
 
 class MyApp : public cnv::Application
 {
 private:
-	std::vector<MCell*> m_field;
-	std::vector<MCell*> m_breadcrumbs;
-	MCell* m_current = nullptr;
-	bool m_backtracking = false;
-	size_t m_horbias = 1;
-	size_t m_verbias = 1;
+	cnv::MazeGenerator m_maze;
+	cnv::MazeGenerator::Algorithm m_algorithm = cnv::MazeGenerator::BACKTRACKER;
 
 public:
-	MyApp(uint16_t width, uint16_t height, uint8_t bitdepth, uint8_t factor) : cnv::Application(width, height, bitdepth, factor)
+	MyApp(uint16_t width, uint16_t height, uint8_t bitdepth, uint8_t factor) : cnv::Application(width, height, bitdepth, factor),
+		m_maze(WIDTH, HEIGHT, std::time(nullptr))
 	{
-		std::srand(std::time(nullptr));
 		layers[0]->pixelbuffer.fill(BLACK);
-		initGenerator();
 	}
 
 	// MyApp(rt::PixelBuffer& pixelbuffer, uint8_t factor) : cnv::Application(pixelbuffer, factor)
 	// {
-	// 
+	//
 	// }
 
 	virtual ~MyApp()
 	{
-		
-	}
 
-	void initGenerator()
-	{
-		// reset
-		m_current = nullptr;
-		for (size_t i = 0; i < m_field.size(); i++) {
-			delete[] m_field[i];
-		}
-		m_field.clear();
-		m_breadcrumbs.clear();
-		m_backtracking = false;
-
-		// new empty m_field
-		for (size_t y = 0; y < HEIGHT; y++) {
-			for (size_t x = 0; x < WIDTH; x++) {
-				MCell* cell = new MCell();
-				cell->col = x;
-				cell->row = y;
-				m_field.push_back(cell);
-			}
-		}
-		m_current = m_field[0];
 	}
 
 	void update(float deltatime) override
@@ -88,178 +88,23 @@ public:
 
 		static int mazecounter = 0;
 		static float frametime = 0.0f;
-		float maxtime = 0.005f - deltatime;
+		float maxtime = 0.5f - deltatime;
 		frametime += deltatime;
 		if (frametime >= maxtime) {
-			static bool s = true;
-			if(s) {
-				s = generateStep();
-				if (!s) {
-					drawMazeGenerator();
-					auto& pixelbuffer = layers[0]->pixelbuffer;
-					pixelbuffer.setPixel(1, 1, RED); // start
-					pixelbuffer.setPixel(WIDTH*2-1, HEIGHT*2-1, BLUE); // end
-					std::string name = pixelbuffer.createFilename("maze", mazecounter);
-					pixelbuffer.write(name);
-					std::cout << name << std::endl;
-					mazecounter++;
-					initGenerator();
-				}
-				s = true;
-			}
-			drawMazeGenerator();
+			auto& pixelbuffer = layers[0]->pixelbuffer;
+			m_maze.generate(m_algorithm);
+			drawMaze(m_maze, pixelbuffer);
+			std::string name = pixelbuffer.createFilename("maze", mazecounter);
+			pixelbuffer.write(name);
+			std::cout << name << std::endl;
+			mazecounter++;
+
+			layers[0]->lock();
 			frametime = 0.0f;
 		}
 	}
 
 private:
-	MCell* getRandomUnvisitedSeperatedNeighbour(MCell* mc, size_t hbias = 1, size_t vbias = 1)
-	{
-		// keep a list of possible neighbours
-		std::vector<MCell*> neighbours;
-		int x = mc->col;
-		int y = mc->row;
-		int index = 0;
-
-		// look right
-		index = rt::index(x+1,y,WIDTH);
-		if( index < WIDTH*HEIGHT && index >= 0 && x < WIDTH-1) {
-			if (!m_field[index]->visited) {
-				for (size_t i = 0; i < hbias; i++) {
-					neighbours.push_back(m_field[index]);
-				}
-			}
-		}
-		// look left
-		index = rt::index(x-1,y,WIDTH);
-		if( index < WIDTH*HEIGHT && index >= 0 && x > 0 ) {
-			if (!m_field[index]->visited) {
-				for (size_t i = 0; i < hbias; i++) {
-					neighbours.push_back(m_field[index]);
-				}
-			}
-		}
-		// look down
-		index = rt::index(x,y+1,WIDTH);
-		if( index < WIDTH*HEIGHT && index >= 0 ) {
-			if (!m_field[index]->visited) {
-				for (size_t i = 0; i < vbias; i++) {
-					neighbours.push_back(m_field[index]);
-				}
-			}
-		}
-		// look up
-		index = rt::index(x,y-1,WIDTH);
-		if( index < WIDTH*HEIGHT && index >= 0 ) {
-			if (!m_field[index]->visited) {
-				for (size_t i = 0; i < vbias; i++) {
-					neighbours.push_back(m_field[index]);
-				}
-			}
-		}
-
-		// there's a valid neighbour!
-		if (neighbours.size() > 0) {
-			// pick one from the list
-			int r = rand()%neighbours.size();
-			return neighbours[r];
-		}
-
-		// no neighbours
-		return nullptr;
-	}
-
-	bool generateStep()
-	{
-		// make 'm_current' find the next place to be
-		m_current->visited = true;
-		// STEP 1: while there is a neighbour...
-		MCell* next = getRandomUnvisitedSeperatedNeighbour(m_current, m_horbias, m_verbias);
-		if (next != nullptr) { // there's still an unvisited neighbour. We're not stuck
-			m_backtracking = false;
-			next->visited = true;
-
-			// STEP 2
-			m_breadcrumbs.push_back(m_current); // drop a breadcrumb on the stack
-
-			// STEP 3
-			removeWalls(m_current, next); // break through the wall
-
-			// STEP 4
-			m_current = next;
-		} else { // we're stuck! backtrack our steps...
-			m_backtracking = true;
-			if (m_breadcrumbs.size() > 0) {
-				m_current = m_breadcrumbs.back(); // make previous our m_current cell
-				m_breadcrumbs.pop_back(); // remove from the m_breadcrumbs (eat the breadcrumb)
-			}
-		}
-
-		// We're back at the start m_field[0]
-		if (m_current->col == 0 && m_current->row == 0) {
-			return false;
-		}
-
-		return true;
-	}
-
-	void removeWalls(MCell* c, MCell* n)
-	{
-		int dx = c->col - n->col;
-		if (dx == 1) {
-			c->walls[3] = 0; // left
-			n->walls[1] = 0; // right
-		} else if (dx == -1) {
-			c->walls[1] = 0;
-			n->walls[3] = 0;
-		}
-
-		int dy = c->row - n->row;
-		if (dy == 1) {
-			c->walls[0] = 0; // top
-			n->walls[2] = 0; // bottom
-		} else if (dy == -1) {
-			c->walls[2] = 0;
-			n->walls[0] = 0;
-		}
-	}
-
-	void drawMazeGenerator()
-	{
-		auto& pixelbuffer = layers[0]->pixelbuffer;
-
-		for (size_t y = 0; y < HEIGHT*2; y+=2) {
-			for (size_t x = 0; x < WIDTH*2; x+=2) {
-				rt::RGBAColor color = BLACK;
-				int index = rt::index(x/2, y/2, WIDTH);
-				MCell* cell = m_field[index];
-				if (cell->visited) {
-					color = WHITE;
-				} else {
-					color = GRAY;
-				}
-				rt::vec2i pos = rt::vec2i(x+1, y+1);
-				pixelbuffer.setPixel(pos.x, pos.y, color);
-
-				if (m_current == cell) {
-					if(m_backtracking) {
-						pixelbuffer.setPixel(pos.x, pos.y, RED);
-					} else {
-						pixelbuffer.setPixel(pos.x, pos.y, BLUE);
-					}
-				}
-
-				// draw walls
-				auto walls = cell->walls;
-				if (walls[0]) { pixelbuffer.setPixel(pos.x, pos.y-1, BLACK); } else { pixelbuffer.setPixel(pos.x, pos.y-1, WHITE); }
-				if (walls[1]) { pixelbuffer.setPixel(pos.x+1, pos.y, BLACK); } else { pixelbuffer.setPixel(pos.x+1, pos.y, WHITE); }
-				// if (walls[2]) { pixelbuffer.setPixel(pos.x, pos.y+1, BLACK); } else { pixelbuffer.setPixel(pos.x, pos.y+1, WHITE); }
-				// if (walls[3]) { pixelbuffer.setPixel(pos.x-1, pos.y, BLACK); } else { pixelbuffer.setPixel(pos.x-1, pos.y, WHITE); }
-			}
-		}
-		layers[0]->lock();
-	}
-
 	void handleInput()
 	{
 		if (input.getKeyDown(cnv::KeyCode::Space)) {
@@ -267,6 +112,11 @@ private:
 			layers[0]->pixelbuffer.printInfo();
 		}
 
+		if (input.getKeyDown(cnv::KeyCode::Alpha1)) { m_algorithm = cnv::MazeGenerator::BACKTRACKER; std::cout << "backtracker" << std::endl; }
+		if (input.getKeyDown(cnv::KeyCode::Alpha2)) { m_algorithm = cnv::MazeGenerator::WILSON; std::cout << "wilson" << std::endl; }
+		if (input.getKeyDown(cnv::KeyCode::Alpha3)) { m_algorithm = cnv::MazeGenerator::KRUSKAL; std::cout << "kruskal" << std::endl; }
+		if (input.getKeyDown(cnv::KeyCode::Alpha4)) { m_algorithm = cnv::MazeGenerator::ELLER; std::cout << "eller" << std::endl; }
+
 		if (input.getMouseDown(0)) {
 			std::cout << "click " << (int) input.getMouseX() << "," << (int) input.getMouseY() << std::endl;
 		}
@@ -280,8 +130,36 @@ private:
 };
 
 
-int main( void )
+int main(int argc, char *argv[])
 {
+	// ./mazegenerator --stream 100000 100000 maze.pbm
+	if (argc == 5 && std::strcmp(argv[1], "--stream") == 0) {
+		return stream(std::strtoul(argv[2], nullptr, 10), std::strtoul(argv[3], nullptr, 10), argv[4]);
+	}
+
+	// ./mazegenerator --batch 1000 [backtracker|wilson|kruskal|eller]
+	if (argc >= 3 && std::strcmp(argv[1], "--batch") == 0) {
+		// a positive number, and nothing else (strtoul would take "-1", " 1" and "1x")
+		char* last = nullptr;
+		unsigned long count = std::strtoul(argv[2], &last, 10);
+		bool valid = argv[2][0] >= '0' && argv[2][0] <= '9' && *last == '\0' && count > 0 && count <= INT_MAX;
+
+		cnv::MazeGenerator::Algorithm algorithm = cnv::MazeGenerator::BACKTRACKER;
+		if (argc >= 4) {
+			std::string name = argv[3];
+			if (name == "wilson") { algorithm = cnv::MazeGenerator::WILSON; }
+			else if (name == "kruskal") { algorithm = cnv::MazeGenerator::KRUSKAL; }
+			else if (name == "eller") { algorithm = cnv::MazeGenerator::ELLER; }
+			else if (name != "backtracker") { valid = false; }
+		}
+		if (!valid) {
+			std::cout << "Usage: ./mazegenerator --batch <count> [backtracker|wilson|kruskal|eller]" << std::endl;
+			return 1;
+		}
+		batch((int)count, algorithm);
+		return 0;
+	}
+
 	MyApp application(WIDTH*2+1, HEIGHT*2+1, 24, 8);
 
 	while (!application.quit())
@@ -7,47 +7,87 @@
  * https://github.com/rktrlng/canvas
  */
 
-#include <ctime>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
-#include <bitset>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <glob.h>
+#endif
 
 #include <canvas/application.h>
+#include <canvas/gridmap.h>
+#include <canvas/parallel.h>
+#include <canvas/pathfinder.h>
 
-struct PCell {
-	int col = 0; // x
-	int row = 0; // y
-	bool visited = false;
-	bool wall = true;
-};
+const bool REPLAY = true; // show how the solver got there
+const int REPLAY_SPEED = 8; // cells per frame
+
+cnv::Pathfinder::Algorithm algorithmByName(const std::string& name)
+{
+	if (name == "astar") { return cnv::Pathfinder::ASTAR; }
+	if (name == "jps") { return cnv::Pathfinder::JPS; }
+	if (name == "deadend") { return cnv::Pathfinder::DEADEND; }
+	return cnv::Pathfinder::BFS;
+}
 
-enum class State { SEARCHING, BACKTRACKING };
+// the path over the maze, with the start and end on top
+void drawPath(rt::PixelBuffer& pixelbuffer, const cnv::GridMap& map, const std::vector<rt::vec2i>& path)
+{
+	for (size_t i = 0; i < path.size(); i++) {
+		pixelbuffer.setPixel(path[i].x, path[i].y, ORANGE);
+	}
+	pixelbuffer.setPixel(map.start().x, map.start().y, RED);
+	pixelbuffer.setPixel(map.end().x, map.end().y, BLUE);
+}
+
+// maze.pbf -> maze_solved_<cells>_<length>.pbf
+std::string solvedFilename(std::string filename, size_t cells, size_t length)
+{
+	// remove .pbf extension if there is one
+	size_t lastindex = filename.find_last_of(".");
+	if (lastindex != std::string::npos && filename.substr(lastindex + 1) == "pbf") {
+		filename = filename.substr(0, lastindex);
+	}
+	return filename + "_solved_" + std::to_string(cells) + "_" + std::to_string(length) + ".pbf";
+}
 
 class MyApp : public cnv::Application
 {
 private:
-	std::vector<PCell*> m_solverfield;
-	std::vector<PCell*> m_breadcrumbs;
-	std::vector<PCell*> m_solution;
-	PCell* m_seeker = nullptr;
-	PCell* m_start = nullptr;
-	PCell* m_end = nullptr;
-	State m_state = State::SEARCHING;
-	size_t m_cols = 0;
-	size_t m_rows = 0;
+	cnv::GridMap m_map;
+	cnv::Pathfinder m_pathfinder;
+	std::vector<size_t> m_trace;
+	std::vector<rt::vec2i> m_solution;
+	size_t m_replayed = 0;
 
 public:
 	std::string filename = "";
 
-	// MyApp(uint16_t cols, uint16_t rows, uint8_t bitdepth, uint8_t factor) : cnv::Application(cols, rows, bitdepth, factor)
-	// {
-	// 	std::srand(std::time(nullptr));
-	// 	init();
-	// }
-
-	MyApp(rt::PixelBuffer& pixelbuffer, uint8_t factor) : cnv::Application(pixelbuffer, factor)
+	MyApp(rt::PixelBuffer& pixelbuffer, uint8_t factor, cnv::Pathfinder::Algorithm algorithm) : cnv::Application(pixelbuffer, factor),
+		m_map(pixelbuffer),
+		m_pathfinder(m_map)
 	{
-		std::srand(std::time(nullptr));
-		initSolver();
+		if (REPLAY) {
+			m_pathfinder.setTrace(&m_trace);
+		}
+		m_pathfinder.solve(algorithm, m_map.start(), m_map.end(), m_solution);
+		const cnv::Pathfinder::Stats& stats = m_pathfinder.stats();
+		std::cout << "path: " << stats.length << " cells, " << stats.expanded << " expanded in " << stats.seconds * 1000 << " ms" << std::endl;
 	}
 
 	virtual ~MyApp()
@@ -55,41 +95,6 @@ public:
 		
 	}
 
-	void initSolver()
-	{
-		// reset
-		m_seeker = nullptr;
-		for (size_t i = 0; i < m_solverfield.size(); i++) {
-			delete[] m_solverfield[i];
-		}
-		m_solverfield.clear();
-		m_breadcrumbs.clear();
-		m_solution.clear();
-
-		m_state = State::SEARCHING;
-
-		auto& pixelbuffer = layers[0]->pixelbuffer;
-		m_cols = pixelbuffer.width();
-		m_rows = pixelbuffer.height();
-
-		// new empty m_solverfield
-		for (size_t y = 0; y < m_rows; y++) {
-			for (size_t x = 0; x < m_cols; x++) {
-				PCell* cell = new PCell();
-				cell->col = x;
-				cell->row = y;
-				rt::RGBAColor color = pixelbuffer.getPixel(x, y);
-				// if (color == BLACK) { cell->wall = true; } // wall (default)
-				if (color == WHITE || color == ORANGE || color == GRAY) { cell->wall = false; } // empty m_solverfield
-				if (color == RED)   { cell->wall = false; m_start = cell; } // m_startpoint
-				if (color == BLUE)  { cell->wall = false; m_end = cell; } // endpoint
-				m_solverfield.push_back(cell);
-			}
-		}
-		m_seeker = m_start;
-		m_solution.push_back(m_seeker);
-	}
-
 	void update(float deltatime) override
 	{
 		handleInput();
@@ -98,178 +103,330 @@ public:
 		float maxtime = 0.01f - deltatime;
 		frametime += deltatime;
 		if (frametime >= maxtime) {
-			// bool solved = solveMaze();
-			solveMaze();
-			
+			replay(REPLAY_SPEED);
 			frametime = 0.0f;
 		}
 	}
 
-	bool solveMaze()
+private:
+	void replay(size_t steps)
 	{
-		static bool found = false;
-		if(!found) {
-			found = solveStep();
-			if (found) {
-				drawMazeSolver();
-				std::cout << "done" << std::endl;
-				auto& pixelbuffer = layers[0]->pixelbuffer;
-				// remove .pbf extension if there is one
-				size_t lastindex = filename.find_last_of(".");
-				if((filename.substr(lastindex + 1) == "pbf")) {
-					filename = filename.substr(0, lastindex); 
-				}
-				filename += "_solved_" + std::to_string(m_solverfield.size()) + "_" + std::to_string(m_solution.size()) + ".pbf";
-				pixelbuffer.write(filename);
-				std::cout << filename << std::endl;
-			}
+		if (m_replayed > m_trace.size()) {
+			return;
+		}
+
+		auto& pixelbuffer = layers[0]->pixelbuffer;
+		size_t end = std::min(m_replayed + steps, m_trace.size());
+		for (size_t i = m_replayed; i < end; i++) {
+			pixelbuffer[m_trace[i]] = GRAY;
+		}
+		m_replayed = end;
+
+		if (m_replayed == m_trace.size()) {
+			drawSolution();
+			m_replayed++; // done
 		}
-		drawMazeSolver();
+		layers[0]->lock();
+	}
+
+	void drawSolution()
+	{
+		auto& pixelbuffer = layers[0]->pixelbuffer;
+		drawPath(pixelbuffer, m_map, m_solution);
 
-		return found;
+		std::cout << "done" << std::endl;
+		filename = solvedFilename(filename, m_map.size(), m_solution.size());
+		pixelbuffer.write(filename);
+		std::cout << filename << std::endl;
 	}
 
-private:
-	PCell* getNextUnvistedDirectNeighbour(PCell* mc)
+	void handleInput()
 	{
-		// keep a list of possible neighbours
-		std::vector<PCell*> neighbours;
-		size_t x = mc->col;
-		size_t y = mc->row;
-		size_t index = 0;
-
-		// look right
-		index = rt::index(x+1,y,m_cols);
-		if (!m_solverfield[index]->wall && !m_solverfield[index]->visited) {
-			neighbours.push_back(m_solverfield[index]);
-		}
-		// look left
-		index = rt::index(x-1,y,m_cols);
-		if (!m_solverfield[index]->wall && !m_solverfield[index]->visited) {
-			neighbours.push_back(m_solverfield[index]);
-		}
-		// look down
-		index = rt::index(x,y+1,m_cols);
-		if (!m_solverfield[index]->wall && !m_solverfield[index]->visited) {
-			neighbours.push_back(m_solverfield[index]);
+		if (input.getKeyDown(cnv::KeyCode::Space)) {
+			std::cout << "spacebar pressed down." << std::endl;
+			layers[0]->pixelbuffer.printInfo();
+			replay(m_trace.size()); // skip to the end
 		}
-		// look up
-		index = rt::index(x,y-1,m_cols);
-		if (!m_solverfield[index]->wall && !m_solverfield[index]->visited) {
-			neighbours.push_back(m_solverfield[index]);
+
+		if (input.getMouseDown(0)) {
+			std::cout << "click " << (int) input.getMouseX() << "," << (int) input.getMouseY() << std::endl;
 		}
 
-		// there's a valid neighbour!
-		if (neighbours.size() > 0) {
-			// pick one from the list
-			int r = rand()%neighbours.size();
-			return neighbours[r];
+		int scrolly = input.getScrollY();
+		if (scrolly != 0) {
+			std::cout << "scroll: " << scrolly << std::endl;
 		}
+	}
 
-		// no neighbours
-		return nullptr;
+};
+
+
+// a maze too big for a pixelbuffer (a PBM from ./mazegenerator --stream): solve it, without a window
+int solveBitmap(const std::string& filename, cnv::Pathfinder::Algorithm algorithm)
+{
+	cnv::GridMap map(0, 0);
+	if (!map.read(filename)) {
+		std::cout << "can't read " << filename << std::endl;
+		return 1;
 	}
 
-	bool solveStep()
+	cnv::Pathfinder pathfinder(map);
+	std::vector<rt::vec2i> path;
+	pathfinder.solve(algorithm, map.start(), map.end(), path);
+	const cnv::Pathfinder::Stats& stats = pathfinder.stats();
+	std::cout << filename << " (" << map.width() << "x" << map.height() << ") path: " << stats.length << " cells, ";
+	std::cout << stats.expanded << " expanded in " << stats.seconds * 1000 << " ms" << std::endl;
+	return path.empty() ? 1 : 0;
+}
+
+// mazes read from disk, waiting for a solver. There's room for a few, so reading doesn't run off with the memory.
+class MazeQueue
+{
+public:
+	struct Maze
 	{
-		// make 'm_seeker' find the next place to be
-		m_seeker->visited = true;
-		// while there is a neighbour...
-		PCell* next = getNextUnvistedDirectNeighbour(m_seeker);
-		if (next != nullptr) { // there's still an unvisited neighbour. We're not stuck
-			m_state = State::SEARCHING;
-			next->visited = true;
-
-			m_breadcrumbs.push_back(m_seeker); // drop a breadcrumb on the stack
-
-			m_seeker = next;
-			m_solution.push_back(m_seeker); // still looks good...
-		} else { // we're stuck! backtrack our steps...
-			m_state = State::BACKTRACKING;
-			if (m_breadcrumbs.size() > 0) {
-				m_seeker = m_breadcrumbs.back(); // make previous our m_seeker cell
-				m_breadcrumbs.pop_back(); // remove from the m_breadcrumbs (eat the breadcrumb)
-			}
-			if (m_solution.size() > 0) {
-				m_solution.pop_back(); // nope, wrong track!
-			}
-		}
+		size_t index; // in the list of files
+		std::unique_ptr<rt::PixelBuffer> pixelbuffer;
+	};
 
-		// We've found the exit!
-		if (m_seeker->col == m_end->col && m_seeker->row == m_end->row) {
-			return true;
-		}
+	MazeQueue(size_t capacity) : _capacity(capacity), _closed(false) { }
 
-		return false;
+	// wait for room
+	void push(Maze maze)
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_room.wait(lock, [&]{ return _mazes.size() < _capacity; });
+		_mazes.push_back(std::move(maze));
+		_ready.notify_one();
 	}
 
-	void drawMazeSolver()
+	// wait for a maze. false: there are no more
+	bool pop(Maze& maze)
 	{
-		auto& pixelbuffer = layers[0]->pixelbuffer;
+		std::unique_lock<std::mutex> lock(_mutex);
+		_ready.wait(lock, [&]{ return !_mazes.empty() || _closed; });
+		if (_mazes.empty()) {
+			return false;
+		}
+		maze = std::move(_mazes.front());
+		_mazes.pop_front();
+		_room.notify_one();
+		return true;
+	}
+
+	// nothing more will be pushed
+	void close()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_closed = true;
+		_ready.notify_all();
+	}
+
+private:
+	size_t _capacity;
+	bool _closed;
+	std::deque<Maze> _mazes;
+	std::mutex _mutex;
+	std::condition_variable _room;
+	std::condition_variable _ready;
+};
+
+// a line of the csv
+struct Solved
+{
+	int width = 0; // 0: couldn't read it
+	int height = 0;
+	size_t length = 0; // 0: no path
+	size_t expanded = 0;
+	double read = 0.0; // seconds
+	double solve = 0.0;
+	double write = 0.0;
+};
+
+double since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
 
-		for (size_t y = 0; y < m_rows; y++) {
-			for (size_t x = 0; x < m_cols; x++) {
-				rt::RGBAColor color = BLACK;
-				int index = rt::index(x, y, m_cols);
-				PCell* cell = m_solverfield[index];
-				if (cell->wall) {
-					color = BLACK;
-				} else {
-					color = WHITE;
-				}
-				if (cell->visited) {
-					// color = GRAY;
-				}
-				rt::vec2i pos = rt::vec2i(x, y);
-				pixelbuffer.setPixel(pos.x, pos.y, color);
+// the .pbf files in a directory, or the files matching a pattern ("maze*.pbf"), but not the solutions
+std::vector<std::string> findMazes(const std::string& where)
+{
+	std::vector<std::string> files;
+#ifdef _WIN32
+	// FindFirstFile takes wildcards in the file name, and gives back only the name
+	std::string pattern = where;
+	std::string path = "";
+	DWORD attributes = GetFileAttributesA(where.c_str());
+	if (attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY)) {
+		path = (where.back() == '/' || where.back() == '\\') ? where : where + "/";
+		pattern = path + "*.pbf";
+	} else {
+		size_t slash = where.find_last_of("/\\");
+		if (slash != std::string::npos) {
+			path = where.substr(0, slash + 1);
+		}
+	}
+	WIN32_FIND_DATAA found;
+	HANDLE handle = FindFirstFileA(pattern.c_str(), &found);
+	if (handle != INVALID_HANDLE_VALUE) {
+		do {
+			if (!(found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+				files.push_back(path + found.cFileName);
+			}
+		} while (FindNextFileA(handle, &found));
+		FindClose(handle);
+	}
+#else
+	DIR* dir = opendir(where.c_str());
+	if (dir != nullptr) {
+		std::string path = where.back() == '/' ? where : where + "/";
+		struct dirent* entry;
+		while ((entry = readdir(dir)) != nullptr) {
+			std::string name = entry->d_name;
+			if (name.size() > 4 && name.substr(name.size() - 4) == ".pbf") {
+				files.push_back(path + name);
 			}
 		}
-
-		// draw m_solution so far
-		for (size_t i = 0; i < m_solution.size(); i++) {
-			pixelbuffer[rt::index(m_solution[i]->col, m_solution[i]->row, m_cols)] = ORANGE;
+		closedir(dir);
+	} else {
+		glob_t found;
+		if (glob(where.c_str(), 0, nullptr, &found) == 0) {
+			for (size_t i = 0; i < found.gl_pathc; i++) {
+				files.push_back(found.gl_pathv[i]);
+			}
 		}
+		globfree(&found);
+	}
+#endif
 
-		// draw m_start + end
-		pixelbuffer.setPixel(m_start->col, m_start->row, RED);
-		pixelbuffer.setPixel(m_end->col, m_end->row, BLUE);
+	files.erase(std::remove_if(files.begin(), files.end(), [](const std::string& file) {
+		return file.find("_solved_") != std::string::npos;
+	}), files.end());
+	std::sort(files.begin(), files.end());
+	return files;
+}
 
-		layers[0]->lock();
+void solve(const std::string& filename, rt::PixelBuffer& pixelbuffer, cnv::Pathfinder::Algorithm algorithm, Solved& solved)
+{
+	solved.width = pixelbuffer.width();
+	solved.height = pixelbuffer.height();
+	if (solved.width == 0 || solved.height == 0) {
+		return;
 	}
 
-	void handleInput()
-	{
-		if (input.getKeyDown(cnv::KeyCode::Space)) {
-			std::cout << "spacebar pressed down." << std::endl;
-			layers[0]->pixelbuffer.printInfo();
-		}
+	cnv::GridMap map(pixelbuffer);
+	cnv::Pathfinder pathfinder(map);
+	std::vector<rt::vec2i> path;
+	pathfinder.solve(algorithm, map.start(), map.end(), path);
+	solved.length = pathfinder.stats().length;
+	solved.expanded = pathfinder.stats().expanded;
+	solved.solve = pathfinder.stats().seconds;
+	if (path.empty()) {
+		return;
+	}
 
-		if (input.getMouseDown(0)) {
-			std::cout << "click " << (int) input.getMouseX() << "," << (int) input.getMouseY() << std::endl;
+	auto start = std::chrono::steady_clock::now();
+	drawPath(pixelbuffer, map, path);
+	pixelbuffer.write(solvedFilename(filename, map.size(), path.size()));
+	solved.write = since(start);
+}
+
+// in quotes, so commas in it don't start a new field (and quotes doubled)
+std::string csvField(const std::string& text)
+{
+	std::string field = "\"";
+	for (char c : text) {
+		if (c == '"') { field += '"'; }
+		field += c;
+	}
+	return field + "\"";
+}
+
+// solve all mazes without a window: one thread reads, all threads of the pool solve and write
+int batch(const std::string& where, cnv::Pathfinder::Algorithm algorithm, const std::string& csv)
+{
+	std::vector<std::string> files = findMazes(where);
+	if (files.empty()) {
+		std::cout << "no mazes in " << where << std::endl;
+		return 1;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<Solved> solved(files.size());
+	cnv::ThreadPool& pool = cnv::ThreadPool::instance();
+	MazeQueue queue(pool.size() * 4);
+
+	std::thread reader([&]() {
+		for (size_t i = 0; i < files.size(); i++) {
+			auto begin = std::chrono::steady_clock::now();
+			MazeQueue::Maze maze;
+			maze.index = i;
+			maze.pixelbuffer.reset(new rt::PixelBuffer());
+			maze.pixelbuffer->read(files[i]);
+			solved[i].read = since(begin);
+			queue.push(std::move(maze));
 		}
+		queue.close();
+	});
 
-		int scrolly = input.getScrollY();
-		if (scrolly != 0) {
-			std::cout << "scroll: " << scrolly << std::endl;
+	pool.run(pool.size(), [&](size_t) {
+		MazeQueue::Maze maze;
+		while (queue.pop(maze)) {
+			solve(files[maze.index], *maze.pixelbuffer, algorithm, solved[maze.index]);
 		}
+	});
+	reader.join();
+
+	std::ofstream out(csv);
+	out << "file,width,height,length,expanded,read_ms,solve_ms,write_ms\n";
+	size_t count = 0;
+	for (size_t i = 0; i < files.size(); i++) {
+		const Solved& s = solved[i];
+		out << csvField(files[i]) << "," << s.width << "," << s.height << "," << s.length << "," << s.expanded << ",";
+		out << s.read * 1000 << "," << s.solve * 1000 << "," << s.write * 1000 << "\n";
+		if (s.length > 0) { count++; }
+	}
+	if (!out.good()) {
+		std::cout << "can't write " << csv << std::endl;
+		return 1;
 	}
 
-};
+	std::cout << "solved " << count << " of " << files.size() << " mazes in " << since(start) << " s, see " << csv << std::endl;
+	return 0;
+}
 
 
 int main(int argc, char *argv[])
 {
 	std::string filename = "maze00000.pbf";
+	cnv::Pathfinder::Algorithm algorithm = cnv::Pathfinder::BFS;
+
+	// ./mazesolver --batch <dir|"maze*.pbf"> [bfs|astar|jps|deadend] [results.csv]
+	if (argc >= 3 && std::strcmp(argv[1], "--batch") == 0) {
+		if (argc >= 4) {
+			algorithm = algorithmByName(argv[3]);
+		}
+		return batch(argv[2], algorithm, argc >= 5 ? argv[4] : "mazesolver.csv");
+	}
 
 	if (argc == 1) {
-		std::cout << "Usage: ./mazesolver [m_solution]" << std::endl;
+		std::cout << "Usage: ./mazesolver [maze.pbf|maze.pbm] [bfs|astar|jps|deadend]" << std::endl;
+		std::cout << "       ./mazesolver --batch <dir|\"maze*.pbf\"> [bfs|astar|jps|deadend] [results.csv]" << std::endl;
 	}
-	if (argc == 2) {
+	if (argc >= 2) {
 		filename = argv[1];
 	}
+	if (argc >= 3) {
+		algorithm = algorithmByName(argv[2]);
+	}
+
+	// a PBM is too big for a window
+	if (filename.size() > 4 && filename.substr(filename.size() - 4) == ".pbm") {
+		return solveBitmap(filename, algorithm);
+	}
 
 	rt::PixelBuffer pixelbuffer(filename);
-	MyApp application(pixelbuffer, 8);
+	MyApp application(pixelbuffer, 8, algorithm);
 	application.filename = filename;
 
 	while (!application.quit())
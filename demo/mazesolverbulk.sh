@@ -1,7 +1,5 @@
 #!/bin/bash
 
-for f in maze*.pbf
-do
-  echo "solving ${f}..."
-  ./mazesolver "${f}"
-done
+# solve all maze*.pbf without a window, results in mazesolver.csv
+# ./mazesolverbulk.sh [bfs|astar|jps|deadend]
+./mazesolver --batch "maze*.pbf" "${1:-bfs}" mazesolver.csv
@@ -10,6 +10,8 @@
 #include <ctime>
 
 #include <canvas/application.h>
+#include <canvas/convolution.h>
+#include <canvas/lenia.h>
 
 #include <pixelbuffer/math/mat3.h>
 
@@ -101,25 +103,63 @@ public:
 };
 
 
+// a ring kernel of radius 13, far too big for a filter
+class Lenia : public Convolution
+{
+public:
+	int radius = 13;
+	float dt = 0.1f;
+	float mu = 0.15f;
+	float sigma = 0.015f;
+
+	Lenia() : Convolution()
+	{
+
+	}
+
+	// growth: -1 .. 1, most at mu
+	float activation(float x) override
+	{
+		return 2.0f * exp(-pow(x - mu, 2.0f) / (2.0f * sigma * sigma)) - 1.0f;
+	}
+
+	virtual float normalize(float x) override
+	{
+		return std::min(1.0f, std::max(0.0f, x));
+	}
+
+};
+
+
 class MyApp : public cnv::Application
 {
 private:
 	uint16_t cols;
 	uint16_t rows;
-	std::vector<float> values;
 
 	// GameOfLife convolution;
 	// Slime convolution;
 	Pathways convolution;
 
+	// the values, convolved with convolution.filter
+	cnv::ConvolutionEngine engine;
+
+	// L toggles between the filter and Lenia
+	Lenia lenia;
+	cnv::LeniaEngine continuous;
+	bool lenia_mode = false;
+
 public:
-	MyApp(uint16_t width, uint16_t height, uint8_t bitdepth, uint8_t factor) : cnv::Application(width, height, bitdepth, factor)
+	MyApp(uint16_t width, uint16_t height, uint8_t bitdepth, uint8_t factor) : cnv::Application(width, height, bitdepth, factor),
+		engine(width, height),
+		continuous(width, height, lenia.radius)
 	{
 		std::srand(std::time(nullptr));
 
 		cols = width;
 		rows = height;
 
+		engine.setKernel(convolution.filter);
 		init();
 	}
 
@@ -135,10 +175,8 @@ public:
 
 	void init()
 	{
-		values.clear();
-		for (size_t i = 0; i < (cols*rows); i++) {
-			values.push_back(rand()%2);
-		}
+		engine.randomize(rand());
+		continuous.randomize(rand());
 	}
 
 	void update(float deltatime) override
@@ -149,7 +187,11 @@ public:
 		float maxtime = 0.1f - deltatime;
 		frametime += deltatime;
 		if (frametime >= maxtime) {
-			updatePixels(convolution);
+			if (lenia_mode) {
+				updatePixels(lenia);
+			} else {
+				updatePixels(convolution);
+			}
 
 			layers[0]->lock();
 			frametime = 0.0f;
@@ -157,40 +199,37 @@ public:
 	}
 
 private:
-	void updatePixels(const Convolution& conv)
+	void updatePixels(Lenia& conv)
 	{
-		std::vector<float> next;
-
-		auto& pixelbuffer = layers[0]->pixelbuffer;
-
-		for (size_t y = 0; y < rows; y++) {
-			for (size_t x = 0; x < cols; x++) {
-				// run filter on values
-				float value = 0.0f;
-				for (int j = -1; j < 2; j++) {
-					for (int i = -1; i < 2; i++) {
-						rt::vec2i wrapped = rt::wrap(rt::vec2i(x+i, y+j), cols, rows);
-						size_t index = rt::index(wrapped.x, wrapped.y, cols);
-						value += values[index];
-					}
-				}
+		// grow by the convolved values, then clamp
+		continuous.step(conv.dt, [&](float* values, size_t count) {
+			for (size_t i = 0; i < count; i++) {
+				values[i] = conv.activation(values[i]);
+			}
+		}, [&](float* values, size_t count) {
+			for (size_t i = 0; i < count; i++) {
+				values[i] = conv.normalize(values[i]);
+			}
+		});
 
-				// activate and store
-				float new_value = convolution.activation(value);
-				new_value = convolution.normalize(new_value);
-				next.push_back(new_value);
+		continuous.render(layers[0]->pixelbuffer);
+		layers[0]->lock();
+	}
 
-				// map from 0-1 to 0-255
-				uint8_t gray = new_value * 255;
-				rt::RGBAColor color = {gray, gray, gray, 255};
-				
-				pixelbuffer.setPixel(x, y, color);
+	void updatePixels(Convolution& conv)
+	{
+		// run filter on values, then activate and store
+		engine.step([&](float* values, size_t count) {
+			for (size_t i = 0; i < count; i++) {
+				float new_value = conv.activation(values[i]);
+				values[i] = conv.normalize(new_value);
 			}
-		}
+		});
 
-		values = next;
+		// map from 0-1 to 0-255
+		engine.render(layers[0]->pixelbuffer);
 
-		// pixelbuffer.blur();
+		// layers[0]->pixelbuffer.blur();
 		layers[0]->lock();
 	}
 
@@ -202,14 +241,22 @@ private:
 			init();
 		}
 
+		if (input.getKeyDown(cnv::KeyCode::L)) {
+			lenia_mode = !lenia_mode;
+			std::cout << (lenia_mode ? "lenia" : "filter") << std::endl;
+		}
+
 		if (input.getMouse(0)) {
-			size_t size = 3;
+			size_t size = lenia_mode ? lenia.radius : 3;
 			int x = (int) input.getMouseX();
 			int y = (int) input.getMouseY();
 			for (size_t j = 0; j < size; j++) {
 				for (size_t i = 0; i < size; i++) {
-					int index = rt::index(i+x,j+y,cols);
-					values[index] = rand()%2;
+					if (lenia_mode) {
+						continuous.set(i+x, j+y, (rand()%256) / 255.0f);
+					} else {
+						engine.set(i+x, j+y, rand()%2);
+					}
 				}
 			}
 			// std::cout << "click " << x << "," << y << std::endl;
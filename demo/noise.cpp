@@ -11,11 +11,14 @@
 
 #include <canvas/application.h>
 #include <canvas/noise.h>
+#include <canvas/animatednoise.h>
 
 class MyApp : public cnv::Application
 {
 private:
 	cnv::PerlinNoise m_pn;
+	std::vector<cnv::PerlinNoise::Octave> m_octaves;
+	cnv::AnimatedNoise* m_animated;
 public:
 	MyApp(uint16_t width, uint16_t height, uint8_t bitdepth, uint8_t factor) : cnv::Application(width, height, bitdepth, factor)
 	{
@@ -24,6 +27,17 @@ public:
 		unsigned int seed = rand()%1000;
 		// unsigned int seed = 42;
 		m_pn = cnv::PerlinNoise(seed);
+
+		// { frequency, multiplier }
+		// m_octaves.push_back( { 1, 32} );
+		m_octaves.push_back( { 2, 16} );
+		m_octaves.push_back( { 4, 8} );
+		m_octaves.push_back( { 8, 4} );
+		m_octaves.push_back( {16, 2} );
+		// m_octaves.push_back( {32, 1} );
+
+		// z moves 0.005 per tick: a slice every 4 ticks
+		m_animated = new cnv::AnimatedNoise(m_pn, width, height, m_octaves, 0.02f);
 	}
 
 	// MyApp(rt::PixelBuffer& pixelbuffer, uint8_t factor) : cnv::Application(pixelbuffer, factor)
@@ -33,7 +47,7 @@ public:
 
 	virtual ~MyApp()
 	{
-
+		delete m_animated;
 	}
 
 	void update(float deltatime) override
@@ -53,31 +67,6 @@ public:
 	}
 
 private:
-	struct Octave
-	{
-		int freq = 1;
-		int multiplier = 1;
-		Octave(int f, int m) : freq(f), multiplier(m) { }
-	};
-
-	double coherentNoise(double x, double y, double z, const std::vector<Octave>& octaves)
-	{
-		double n = 0.0;
-		double div = 0.0;
-
-		for (size_t i = 0; i < octaves.size(); i++)
-		{
-			int freq = octaves[i].freq;
-			int mult = octaves[i].multiplier;
-			double a = m_pn.noise(x*freq, y*freq, z*freq) * mult;
-			n += a;
-			div += mult;
-		}
-		n /= div;
-
-		return n;
-	}
-
 	void noise()
 	{
 		auto& pixelbuffer = layers[0]->pixelbuffer;
@@ -87,25 +76,18 @@ private:
 
 		size_t rows = pixelbuffer.height();
 		size_t cols = pixelbuffer.width();
+		const std::vector<float>& values = m_animated->sample(z);
+
 		for (size_t i = 0; i < rows; i++) {
 			for (size_t j = 0; j < cols; j++) {
-				double x = (double)j/((double)cols);
-				double y = (double)i/((double)rows);
-				// double z = 0.0f;
-
-				std::vector<Octave> octaves; // { frequency, multiplier }
-				// octaves.push_back( { 1, 32} );
-				octaves.push_back( { 2, 16} );
-				octaves.push_back( { 4, 8} );
-				octaves.push_back( { 8, 4} );
-				octaves.push_back( {16, 2} );
-				// octaves.push_back( {32, 1} );
-				double n = coherentNoise(x, y, z, octaves);
+				double n = values[i * cols + j];
 
 				uint8_t p = 255 * n;
 
 				// Wood like structure
 				if (false) {
+					double x = (double)j/((double)cols);
+					double y = (double)i/((double)rows);
 					n = 20 * m_pn.noise(x, y, z);
 					n = n - floor(n);
 					p = 255 * n;
@@ -10,6 +10,7 @@
 #include <ctime>
 
 #include <canvas/application.h>
+#include <canvas/voronoi.h>
 
 struct Agent
 {
@@ -37,15 +38,25 @@ class MyApp : public cnv::Application
 private:
 	std::vector<Agent*> m_agents;
 
+	cnv::VoronoiEngine m_voronoi;
+	std::vector<rt::vec2i> m_seeds;
+	std::vector<rt::RGBAColor> m_colors;
+	bool m_jumpflood = false;
+
 public:
-	MyApp(uint16_t width, uint16_t height, uint8_t bitdepth, uint8_t factor) : cnv::Application(width, height, bitdepth, factor)
+	MyApp(uint16_t width, uint16_t height, uint8_t bitdepth, uint8_t factor) : cnv::Application(width, height, bitdepth, factor),
+		m_voronoi(width, height)
 	{
 		std::srand(std::time(nullptr));
 
 		for (size_t i = 0; i < 50; i++)
 		{
 			m_agents.push_back(new Agent(width, height));
+			m_colors.push_back(m_agents.back()->color);
 		}
+
+		// keep the window responsive
+		setThreaded(true);
 	}
 
 	// MyApp(rt::PixelBuffer& pixelbuffer, uint8_t factor) : cnv::Application(pixelbuffer, factor)
@@ -87,36 +98,21 @@ private:
 
 	void voronoi()
 	{
-		auto& pixelbuffer = layers[0]->pixelbuffer;
-
-		size_t rows = pixelbuffer.height();
-		size_t cols = pixelbuffer.width();
-		for (size_t y = 0; y < rows; y++) {
-			for (size_t x = 0; x < cols; x++) {
-				int max_distance = rt::vec2i(rows, cols).mag();
-				int min_distance = max_distance;
-				Agent* agent = m_agents[0];
-				for (size_t i = 0; i < m_agents.size(); i++)
-				{
-					rt::vec2i delta = rt::vec2i(x,y) - m_agents[i]->position;
-					int current_distance = delta.mag();
-					if (current_distance < min_distance)
-					{
-						min_distance = current_distance;
-						agent = m_agents[i];
-					}
-				}
-				
-				// map min_distance to color
-				rt::RGBAColor color = agent->color;
-				// int value = rt::map(min_distance, 0, max_distance, 0, 255);
-				// color.r = value;
-				// color.g = value;
-				// color.b = value;
-
-				pixelbuffer.setPixel(x, y, color);
-			}
+		m_seeds.clear();
+		for (size_t i = 0; i < m_agents.size(); i++)
+		{
+			m_seeds.push_back(m_agents[i]->position);
 		}
+		m_voronoi.setSeeds(m_seeds);
+
+		if (m_jumpflood) {
+			m_voronoi.jumpFlood();
+		} else {
+			// agents move 1 pixel at most, only the cells near the edges can change
+			m_voronoi.update();
+		}
+
+		m_voronoi.render(layers[0]->pixelbuffer, m_colors);
 	}
 
 	void handleInput() {
@@ -125,6 +121,11 @@ private:
 			layers[0]->pixelbuffer.printInfo();
 		}
 
+		if (input.getKeyDown(cnv::KeyCode::J)) {
+			m_jumpflood = !m_jumpflood;
+			std::cout << (m_jumpflood ? "jump flooding" : "exact") << std::endl;
+		}
+
 		if (input.getMouseDown(0)) {
 			std::cout << "click " << (int) input.getMouseX() << "," << (int) input.getMouseY() << std::endl;
 		}